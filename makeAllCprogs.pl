@@ -27,6 +27,7 @@
 #** 18.07.2021  JE    Added '-c' for compilation with clang.
 #** 25.01.2023  JE    Changed dispatchError() logic to default.
 #** 13.01.2023  JE    Added '-r' for using regex lib explicitly.
+#** 17.10.2026  JE    Added '-lpthread' to default libraries.
 #*******************************************************************************
 
 
@@ -42,7 +43,7 @@ use File::Spec;
 #*******************************************************************************
 #* infos
 
-my $g_meversion = '0.12.1';
+my $g_meversion = '0.12.2';
 my $g_mename    = getMeName();
 my $g_mehome    = getMeHome();
 my $g_mebindir  = getMeBinDir(); # Needs $g_mehome
@@ -144,7 +145,8 @@ sub usage($;$) { my ($err, $txt) = @_;
   $msg .= "  -b <path>:     path to compiled programs (default '~/bin/')\n";
   $msg .= "  -r:            compile with regex support (default without -l pcre2-8)\n";
   $msg .= "  --dellibs:     delete default libs, use prior use of any other '-l'\n";
-  $msg .= "  -l <lib>:      add a lib for each '-l' (default -l m -l crypto)\n";
+  $msg .= "  -l <lib>:      add a lib for each '-l' (default -l m -l crypto\n";
+  $msg .= "                 -l pthread)\n";
   $msg .= "  -h|--help:     print this help\n";
   $msg .= "  -v|--version:  print version of program\n";
   #Summary:************************ 80 chars width ****************************************
@@ -197,7 +199,7 @@ sub getOptions(@) { my (@args) = @_;
   $g_a{'optimise'} = ' -Ofast';
   $g_a{'bindir'}   = $g_mebindir;
   $g_a{'regex'}    = '';
-  $g_a{'libs'}     = ' -lm -lcrypto';
+  $g_a{'libs'}     = ' -lm -lcrypto -lpthread';
   @g_args          = ();
 
   # Loop all arguments from command line POSIX style.
@@ -0,0 +1,1509 @@
+/*******************************************************************************
+ ** Name: c_ascii85.h
+ ** Purpose:  Provides an incremental ascii85 decoder and encoder.
+ ** Author: (JE) Jens Elstner
+ ** Version: v0.2.0
+ *******************************************************************************
+ ** Date        User  Log
+ **-----------------------------------------------------------------------------
+ ** 17.10.2026  JE    Created lib from the codec of 'ascii85'.
+ ** 17.10.2026  JE    Added 'lut' and 'avx512' kernels, own encoder kernel.
+ *******************************************************************************/
+
+
+//******************************************************************************
+//* header
+
+#ifndef C_ASCII85_H
+#define C_ASCII85_H
+
+
+//******************************************************************************
+//* includes
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define A85_X86               // SIMD kernels, selected at runtime via cpuid.
+#include <immintrin.h>
+#endif
+
+
+//******************************************************************************
+//* defines and macros
+
+// To decode a buffer in memory use
+// t_a85dec tDec;
+// a85DecInit(&tDec);
+// sOut = a85DecFeed(&tDec, pucIn, sLen, pucOut);  // a85DecBound(sLen) bytes.
+// iErr = a85DecFinish(&tDec);
+// Encoding works alike with a85EncInit(), a85EncFeed() and a85EncFinish().
+
+// ASCII85 special chars.
+#define A85_C_MIN ('!')
+#define A85_C_MAX ('u')
+#define A85_C_NUL ('z')
+#define A85_C_EOB ('~')
+
+// Size of decoder's char buffer and words per block of encoder.
+#define A85_BUFSIZE   (16 * 1024)
+#define A85_ENC_WORDS (A85_BUFSIZE / 5)
+
+// States of decoder.
+#define A85_DEC_SEEK    0x00
+#define A85_DEC_SEEK_LT 0x01
+#define A85_DEC_DATA    0x02
+#define A85_DEC_DONE    0x03
+#define A85_DEC_SKIP    0x04
+
+// Decoder's 'iWant', decode all blocks or none, to only list them.
+#define A85_BLOCK_ALL  (-1)
+#define A85_BLOCK_NONE (-2)
+
+// a85DecFinish()
+#define A85_OK            0x00
+#define A85_ERR_NO_BLOCK  0x01  // No '<~' at all.
+#define A85_ERR_NO_EOB    0x02  // Block without '~>'.
+#define A85_ERR_NOT_FOUND 0x03  // Wanted block is missing.
+
+// Division by 85 as multiplication with reciprocal, exact for all uint32_t.
+#define A85_DIV85_MAGIC 0xc0c0c0c1u
+#define A85_DIV85_SHIFT 38
+#define A85_DIV85(x)    ((uint32_t) (((uint64_t) (x) * A85_DIV85_MAGIC) >> A85_DIV85_SHIFT))
+
+
+//******************************************************************************
+//* type definition
+
+// Called at the end of every block, decoded or not.
+typedef void (*t_a85block)(void* pvUser, int iBlock, off_t oBeg, off_t oEob);
+
+// Decoder, keeps partial groups between fed chunks. Settings may be changed
+// after a85DecInit().
+typedef struct s_a85dec {
+  int        iWant;      // Block to decode, A85_BLOCK_ALL or A85_BLOCK_NONE.
+  off_t      oSkip;      // Chars still to skip before decoding.
+  off_t      oDrop;      // Decoded bytes still to drop before output.
+  off_t      oLeft;      // Decoded bytes still to output, -1 for all.
+  off_t      oPos;       // Input offset of next fed chunk.
+  int        iBlock;     // Index of current block.
+  t_a85block pfBlock;    // Called at each block's end, if set.
+  void*      pvUser;     // Passed to pfBlock.
+  int        iState;     // One of A85_DEC_*.
+  off_t      oBlockBeg;  // Input offset of current block's '<~'.
+  size_t     sChars;     // Valid chars in char buffer.
+  uint8_t    aucChars[A85_BUFSIZE + 5];  // Filtered chars, 'z' expanded.
+} t_a85dec;
+
+// Encoder, keeps an incomplete word between fed chunks. Settings may be
+// changed after a85EncInit().
+typedef struct s_a85enc {
+  int     iWrap;     // Line width, 0 for no wrapping.
+  int     iNoZero;   // Write '!!!!!' instead of 'z' for zero words.
+  int     iStarted;  // '<~' was put out.
+  size_t  sCol;      // Chars of current line.
+  size_t  sLast;     // Bytes of incomplete word.
+  uint8_t aucLast[4];
+  uint8_t aucChars[5 * A85_ENC_WORDS];
+} t_a85enc;
+
+// Decoder and encoder kernels, one set per instruction set.
+typedef struct s_a85kernel {
+  const char* pcName;
+  int    (*isSupported)(void);
+  size_t (*filter)(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen);
+  size_t (*count)(const uint8_t* pucIn, size_t sLen);
+  void   (*decode)(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups);
+  void   (*encode)(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords);
+} t_a85kernel;
+
+
+//******************************************************************************
+//* function forward declarations
+//* For a better function's arrangement.
+
+// External functions.
+
+// Kernels.
+int         a85SelectKernel(const char* pcName);
+int         a85SelectDecKernel(const char* pcName);
+int         a85SelectEncKernel(const char* pcName);
+int         a85KernelCount(void);
+const char* a85KernelName(int iKernel);
+int         a85KernelSupported(int iKernel);
+const char* a85KernelInUse(void);
+const char* a85EncKernelInUse(void);
+
+// Scanning.
+const uint8_t* a85FindPayload(const uint8_t* pucIn, const uint8_t* pucEnd);
+size_t         a85Count(const uint8_t* pucIn, size_t sLen);
+
+// Decoder.
+void   a85DecInit(t_a85dec* ptDec);
+size_t a85DecBound(size_t sLen);
+void   a85DecSeek(t_a85dec* ptDec, off_t oBlockBeg, off_t oPos, off_t oSkip);
+size_t a85DecFeed(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen, uint8_t* pucOut);
+size_t a85DecFinishChunk(t_a85dec* ptDec, const uint8_t* pucNext, size_t sLen, uint8_t* pucOut);
+int    a85DecFinish(const t_a85dec* ptDec);
+
+// Encoder.
+void   a85EncInit(t_a85enc* ptEnc);
+size_t a85EncBound(size_t sLen);
+size_t a85EncFeed(t_a85enc* ptEnc, const uint8_t* pucIn, size_t sLen, uint8_t* pucOut);
+size_t a85EncFinish(t_a85enc* ptEnc, uint8_t* pucOut);
+
+
+//******************************************************************************
+//* private functions
+
+
+//******************************************************************************
+//*** decoder kernels
+
+/*******************************************************************************
+ * Name:  a85_filter_scalar
+ * Purpose: Appends all valid chars of chunk to char buffer, expands 'z' and
+ *          skips whitespaces. Stops at '~' or if char buffer is full.
+ *          Returns count of consumed bytes.
+ *******************************************************************************/
+static size_t a85_filter_scalar(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  uint8_t* pucChars = ptDec->aucChars;
+  size_t   sChars   = ptDec->sChars;
+  size_t   i        = 0;
+
+  // Keep room for an expanded 'z'.
+  for (i = 0; i < sLen && sChars + 5 <= A85_BUFSIZE; ++i) {
+    uint8_t c = pucIn[i];
+    if (c == A85_C_EOB) {
+      ptDec->iState = A85_DEC_DONE;
+      ++i;
+      break;
+    }
+    if (c == A85_C_NUL) {
+      for (int j = 0; j < 5; ++j) pucChars[sChars++] = A85_C_MIN;
+      continue;
+    }
+    if (c < A85_C_MIN || c > A85_C_MAX) continue;
+    pucChars[sChars++] = c;
+  }
+
+  ptDec->sChars = sChars;
+  return i;
+}
+
+/*******************************************************************************
+ * Name:  a85_decode_scalar
+ * Purpose: Converts groups of 5 chars into 4 bytes each, big-endian.
+ *******************************************************************************/
+static void a85_decode_scalar(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups) {
+  for (size_t g = 0; g < sGroups; ++g) {
+    const uint8_t* n = pucChars + 5 * g;
+
+    // Calculation of 4 Bytes from five chars, wraps around like uint32_t.
+    uint32_t u32Int = (uint32_t) (n[0] - 33) * 85 * 85 * 85 * 85
+                    + (uint32_t) (n[1] - 33) * 85 * 85 * 85
+                    + (uint32_t) (n[2] - 33) * 85 * 85
+                    + (uint32_t) (n[3] - 33) * 85
+                    + (uint32_t) (n[4] - 33);
+
+    pucOut[4 * g + 0] = (uint8_t) (u32Int >> 24);
+    pucOut[4 * g + 1] = (uint8_t) (u32Int >> 16);
+    pucOut[4 * g + 2] = (uint8_t) (u32Int >>  8);
+    pucOut[4 * g + 3] = (uint8_t) (u32Int      );
+  }
+}
+
+/*******************************************************************************
+ * Name:  a85_count_scalar
+ * Purpose: Counts valid chars of a payload without '~', 'z' counts 5 chars.
+ *******************************************************************************/
+static size_t a85_count_scalar(const uint8_t* pucIn, size_t sLen) {
+  size_t sChars = 0;
+
+  for (size_t i = 0; i < sLen; ++i) {
+    if (pucIn[i] == A85_C_NUL)                                 sChars += 5;
+    else if (pucIn[i] >= A85_C_MIN && pucIn[i] <= A85_C_MAX) sChars += 1;
+  }
+
+  return sChars;
+}
+
+// Value of a char pair, indexed by 1st char << 7 | 2nd char, and char pair
+// of every value of 2 digits.
+static uint16_t a85_au16DecPair[128 * 128];
+static uint8_t  a85_aucEncPair[85 * 85][2];
+
+/*******************************************************************************
+ * Name:  a85_init_pair_tables
+ * Purpose: Creates the tables of the lookup kernels.
+ *******************************************************************************/
+static void a85_init_pair_tables(void) {
+  for (int i = 0; i < 85; ++i) {
+    for (int j = 0; j < 85; ++j) {
+      a85_au16DecPair[(A85_C_MIN + i) << 7 | (A85_C_MIN + j)] = (uint16_t) (i * 85 + j);
+      a85_aucEncPair[i * 85 + j][0] = (uint8_t) (A85_C_MIN + i);
+      a85_aucEncPair[i * 85 + j][1] = (uint8_t) (A85_C_MIN + j);
+    }
+  }
+}
+
+/*******************************************************************************
+ * Name:  a85_decode_lut
+ * Purpose: Like a85_decode_scalar(), but looks up 2 digits per char pair.
+ *          Needs valid chars only, as the filter puts out.
+ *******************************************************************************/
+static void a85_decode_lut(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups) {
+  for (size_t g = 0; g < sGroups; ++g) {
+    const uint8_t* n = pucChars + 5 * g;
+
+    // Wraps around like uint32_t.
+    uint32_t u32Int = (uint32_t) a85_au16DecPair[n[0] << 7 | n[1]] * 85 * 85 * 85
+                    + (uint32_t) a85_au16DecPair[n[2] << 7 | n[3]] * 85
+                    + (uint32_t) (n[4] - 33);
+
+    pucOut[4 * g + 0] = (uint8_t) (u32Int >> 24);
+    pucOut[4 * g + 1] = (uint8_t) (u32Int >> 16);
+    pucOut[4 * g + 2] = (uint8_t) (u32Int >>  8);
+    pucOut[4 * g + 3] = (uint8_t) (u32Int      );
+  }
+}
+
+#ifdef A85_X86
+
+// Shuffle indices to compact 8 bytes by a bit mask of valid bytes.
+static uint8_t a85_aucCompact[256][8];
+
+/*******************************************************************************
+ * Name:  a85_init_compact_table
+ * Purpose: Creates the shuffle indices for every 8 bit mask of valid bytes.
+ *******************************************************************************/
+static void a85_init_compact_table(void) {
+  for (int m = 0; m < 256; ++m) {
+    int k = 0;
+    for (int b = 0; b < 8; ++b)
+      if (m & (1 << b)) a85_aucCompact[m][k++] = b;
+    for (; k < 8; ++k) a85_aucCompact[m][k] = 0x80;
+  }
+}
+
+/*******************************************************************************
+ * Name:  a85_valid_mask16
+ * Purpose: Returns a bit mask of all bytes within '!' ... 'u'.
+ *******************************************************************************/
+__attribute__((target("sse4.1")))
+static inline uint32_t a85_valid_mask16(__m128i xIn) {
+  __m128i xGe = _mm_cmpeq_epi8(_mm_max_epu8(xIn, _mm_set1_epi8(A85_C_MIN)), xIn);
+  __m128i xLe = _mm_cmpeq_epi8(_mm_min_epu8(xIn, _mm_set1_epi8(A85_C_MAX)), xIn);
+  return (uint32_t) _mm_movemask_epi8(_mm_and_si128(xGe, xLe));
+}
+
+/*******************************************************************************
+ * Name:  a85_special_mask16
+ * Purpose: Returns a bit mask of all 'z' and '~' bytes.
+ *******************************************************************************/
+__attribute__((target("sse4.1")))
+static inline uint32_t a85_special_mask16(__m128i xIn) {
+  __m128i xNul = _mm_cmpeq_epi8(xIn, _mm_set1_epi8(A85_C_NUL));
+  __m128i xEob = _mm_cmpeq_epi8(xIn, _mm_set1_epi8(A85_C_EOB));
+  return (uint32_t) _mm_movemask_epi8(_mm_or_si128(xNul, xEob));
+}
+
+/*******************************************************************************
+ * Name:  a85_compact16
+ * Purpose: Stores all bytes flagged in mask contiguously, needs 16 bytes room.
+ *          Returns pointer behind the last stored byte.
+ *******************************************************************************/
+__attribute__((target("sse4.1,popcnt")))
+static inline uint8_t* a85_compact16(uint8_t* pucDst, __m128i xIn, uint32_t uMask) {
+  uint32_t uLo = uMask & 0xff;
+  uint32_t uHi = uMask >> 8;
+  uint64_t u64Lo = 0;
+  uint64_t u64Hi = 0;
+  __m128i  xOut;
+
+  if (uMask == 0xffff) {
+    _mm_storeu_si128((__m128i*) pucDst, xIn);
+    return pucDst + 16;
+  }
+
+  // Indices of upper half must point to bytes 8 ... 15.
+  memcpy(&u64Lo, a85_aucCompact[uLo], 8);
+  memcpy(&u64Hi, a85_aucCompact[uHi], 8);
+  u64Hi += 0x0808080808080808ULL;
+
+  xOut = _mm_shuffle_epi8(xIn, _mm_set_epi64x((long long) u64Hi, (long long) u64Lo));
+  _mm_storel_epi64((__m128i*) pucDst, xOut);
+  pucDst += __builtin_popcount(uLo);
+  _mm_storel_epi64((__m128i*) pucDst, _mm_srli_si128(xOut, 8));
+  return pucDst + __builtin_popcount(uHi);
+}
+
+/*******************************************************************************
+ * Name:  a85_filter_sse41
+ * Purpose: Like a85_filter_scalar(), but compacts 16 bytes per step with pshufb.
+ *          Blocks with 'z' or '~' are left to the scalar filter.
+ *******************************************************************************/
+__attribute__((target("sse4.1,popcnt")))
+static size_t a85_filter_sse41(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  uint8_t* pucDst = ptDec->aucChars + ptDec->sChars;
+  uint8_t* pucEnd = ptDec->aucChars + A85_BUFSIZE - 5 * 16;
+  size_t   i      = 0;
+
+  for (i = 0; i + 16 <= sLen && pucDst <= pucEnd; i += 16) {
+    __m128i xIn = _mm_loadu_si128((const __m128i*) (pucIn + i));
+
+    if (a85_special_mask16(xIn)) {
+      ptDec->sChars = pucDst - ptDec->aucChars;
+      size_t sDone  = a85_filter_scalar(ptDec, pucIn + i, 16);
+      pucDst        = ptDec->aucChars + ptDec->sChars;
+      if (ptDec->iState == A85_DEC_DONE) return i + sDone;
+      continue;
+    }
+    pucDst = a85_compact16(pucDst, xIn, a85_valid_mask16(xIn));
+  }
+
+  ptDec->sChars = pucDst - ptDec->aucChars;
+  return i + a85_filter_scalar(ptDec, pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_filter_avx2
+ * Purpose: Like a85_filter_sse41(), but checks 32 bytes per step.
+ *******************************************************************************/
+__attribute__((target("avx2,popcnt")))
+static size_t a85_filter_avx2(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  uint8_t* pucDst = ptDec->aucChars + ptDec->sChars;
+  uint8_t* pucEnd = ptDec->aucChars + A85_BUFSIZE - 5 * 32;
+  __m256i  yMin   = _mm256_set1_epi8(A85_C_MIN);
+  __m256i  yMax   = _mm256_set1_epi8(A85_C_MAX);
+  __m256i  yNul   = _mm256_set1_epi8(A85_C_NUL);
+  __m256i  yEob   = _mm256_set1_epi8(A85_C_EOB);
+  size_t   i      = 0;
+
+  for (i = 0; i + 32 <= sLen && pucDst <= pucEnd; i += 32) {
+    __m256i  yIn  = _mm256_loadu_si256((const __m256i*) (pucIn + i));
+    __m256i  ySpc = _mm256_or_si256(_mm256_cmpeq_epi8(yIn, yNul), _mm256_cmpeq_epi8(yIn, yEob));
+    __m256i  yGe  = _mm256_cmpeq_epi8(_mm256_max_epu8(yIn, yMin), yIn);
+    __m256i  yLe  = _mm256_cmpeq_epi8(_mm256_min_epu8(yIn, yMax), yIn);
+    uint32_t uMask;
+
+    if (_mm256_movemask_epi8(ySpc)) {
+      ptDec->sChars = pucDst - ptDec->aucChars;
+      size_t sDone  = a85_filter_scalar(ptDec, pucIn + i, 32);
+      pucDst        = ptDec->aucChars + ptDec->sChars;
+      if (ptDec->iState == A85_DEC_DONE) return i + sDone;
+      continue;
+    }
+
+    uMask = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(yGe, yLe));
+    if (uMask == 0xffffffff) {
+      _mm256_storeu_si256((__m256i*) pucDst, yIn);
+      pucDst += 32;
+      continue;
+    }
+    pucDst = a85_compact16(pucDst, _mm256_castsi256_si128(yIn),      uMask & 0xffff);
+    pucDst = a85_compact16(pucDst, _mm256_extracti128_si256(yIn, 1), uMask >> 16);
+  }
+
+  ptDec->sChars = pucDst - ptDec->aucChars;
+  return i + a85_filter_scalar(ptDec, pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_count_sse41
+ * Purpose: Like a85_count_scalar(), but with bit masks of 16 bytes per step.
+ *******************************************************************************/
+__attribute__((target("sse4.1,popcnt")))
+static size_t a85_count_sse41(const uint8_t* pucIn, size_t sLen) {
+  size_t sChars = 0;
+  size_t i      = 0;
+
+  for (i = 0; i + 16 <= sLen; i += 16) {
+    __m128i xIn = _mm_loadu_si128((const __m128i*) (pucIn + i));
+    sChars += __builtin_popcount(a85_valid_mask16(xIn));
+    sChars += 5 * __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(xIn, _mm_set1_epi8(A85_C_NUL))));
+  }
+
+  return sChars + a85_count_scalar(pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_count_avx2
+ * Purpose: Like a85_count_sse41(), but with 32 bytes per step.
+ *******************************************************************************/
+__attribute__((target("avx2,popcnt")))
+static size_t a85_count_avx2(const uint8_t* pucIn, size_t sLen) {
+  __m256i yMin   = _mm256_set1_epi8(A85_C_MIN);
+  __m256i yMax   = _mm256_set1_epi8(A85_C_MAX);
+  __m256i yNul   = _mm256_set1_epi8(A85_C_NUL);
+  size_t  sChars = 0;
+  size_t  i      = 0;
+
+  for (i = 0; i + 32 <= sLen; i += 32) {
+    __m256i yIn = _mm256_loadu_si256((const __m256i*) (pucIn + i));
+    __m256i yGe = _mm256_cmpeq_epi8(_mm256_max_epu8(yIn, yMin), yIn);
+    __m256i yLe = _mm256_cmpeq_epi8(_mm256_min_epu8(yIn, yMax), yIn);
+    sChars += __builtin_popcount((uint32_t) _mm256_movemask_epi8(_mm256_and_si256(yGe, yLe)));
+    sChars += 5 * __builtin_popcount((uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(yIn, yNul)));
+  }
+
+  return sChars + a85_count_scalar(pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_decode_sse41
+ * Purpose: Like a85_decode_scalar(), but sums up 4 groups in vector lanes.
+ *          Group 0 ... 2 are taken from the first load, group 3 from the 2nd.
+ *******************************************************************************/
+__attribute__((target("sse4.1")))
+static void a85_decode_sse41(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups) {
+  const __m128i xBswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i x33    = _mm_set1_epi32(33);
+  const __m128i x85    = _mm_set1_epi32(85);
+  __m128i       axLo[5];
+  __m128i       axHi[5];
+  size_t        g      = 0;
+
+  // Char k of each group into the lowest byte of its 32 bit lane.
+  for (int k = 0; k < 5; ++k) {
+    axLo[k] = _mm_setr_epi8(k, -1, -1, -1, 5 + k, -1, -1, -1, 10 + k, -1, -1, -1, -1, -1, -1, -1);
+    axHi[k] = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11 + k, -1, -1, -1);
+  }
+
+  for (g = 0; g + 4 <= sGroups; g += 4) {
+    const uint8_t* p    = pucChars + 5 * g;
+    __m128i        xA   = _mm_loadu_si128((const __m128i*) p);
+    __m128i        xB   = _mm_loadu_si128((const __m128i*) (p + 4));
+    __m128i        xSum = _mm_setzero_si128();
+
+    for (int k = 0; k < 5; ++k) {
+      __m128i xD = _mm_or_si128(_mm_shuffle_epi8(xA, axLo[k]), _mm_shuffle_epi8(xB, axHi[k]));
+      xSum = _mm_add_epi32(_mm_mullo_epi32(xSum, x85), _mm_sub_epi32(xD, x33));
+    }
+    _mm_storeu_si128((__m128i*) (pucOut + 4 * g), _mm_shuffle_epi8(xSum, xBswap));
+  }
+
+  a85_decode_scalar(pucOut + 4 * g, pucChars + 5 * g, sGroups - g);
+}
+
+/*******************************************************************************
+ * Name:  a85_decode_avx2
+ * Purpose: Like a85_decode_sse41(), but with 8 groups, 4 in each 128 bit lane.
+ *******************************************************************************/
+__attribute__((target("avx2")))
+static void a85_decode_avx2(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups) {
+  const __m256i yBswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m256i y33    = _mm256_set1_epi32(33);
+  const __m256i y85    = _mm256_set1_epi32(85);
+  __m256i       ayLo[5];
+  __m256i       ayHi[5];
+  size_t        g      = 0;
+
+  for (int k = 0; k < 5; ++k) {
+    ayLo[k] = _mm256_broadcastsi128_si256(
+                _mm_setr_epi8(k, -1, -1, -1, 5 + k, -1, -1, -1, 10 + k, -1, -1, -1, -1, -1, -1, -1));
+    ayHi[k] = _mm256_broadcastsi128_si256(
+                _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11 + k, -1, -1, -1));
+  }
+
+  for (g = 0; g + 8 <= sGroups; g += 8) {
+    const uint8_t* p    = pucChars + 5 * g;
+    __m256i        yA   = _mm256_inserti128_si256(
+                            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) p)),
+                            _mm_loadu_si128((const __m128i*) (p + 20)), 1);
+    __m256i        yB   = _mm256_inserti128_si256(
+                            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) (p + 4))),
+                            _mm_loadu_si128((const __m128i*) (p + 24)), 1);
+    __m256i        ySum = _mm256_setzero_si256();
+
+    for (int k = 0; k < 5; ++k) {
+      __m256i yD = _mm256_or_si256(_mm256_shuffle_epi8(yA, ayLo[k]), _mm256_shuffle_epi8(yB, ayHi[k]));
+      ySum = _mm256_add_epi32(_mm256_mullo_epi32(ySum, y85), _mm256_sub_epi32(yD, y33));
+    }
+    _mm256_storeu_si256((__m256i*) (pucOut + 4 * g), _mm256_shuffle_epi8(ySum, yBswap));
+  }
+
+  a85_decode_scalar(pucOut + 4 * g, pucChars + 5 * g, sGroups - g);
+}
+
+
+// Index of digit k of each group of 16 within 80 chars, one per 32 bit lane.
+static const uint8_t a85_aucDecAvx512[5][64] = {
+  {
+      0,   0,   0,   0,   5,   0,   0,   0,  10,   0,   0,   0,  15,   0,   0,   0,
+     20,   0,   0,   0,  25,   0,   0,   0,  30,   0,   0,   0,  35,   0,   0,   0,
+     40,   0,   0,   0,  45,   0,   0,   0,  50,   0,   0,   0,  55,   0,   0,   0,
+     60,   0,   0,   0,  65,   0,   0,   0,  70,   0,   0,   0,  75,   0,   0,   0
+  },
+  {
+      1,   0,   0,   0,   6,   0,   0,   0,  11,   0,   0,   0,  16,   0,   0,   0,
+     21,   0,   0,   0,  26,   0,   0,   0,  31,   0,   0,   0,  36,   0,   0,   0,
+     41,   0,   0,   0,  46,   0,   0,   0,  51,   0,   0,   0,  56,   0,   0,   0,
+     61,   0,   0,   0,  66,   0,   0,   0,  71,   0,   0,   0,  76,   0,   0,   0
+  },
+  {
+      2,   0,   0,   0,   7,   0,   0,   0,  12,   0,   0,   0,  17,   0,   0,   0,
+     22,   0,   0,   0,  27,   0,   0,   0,  32,   0,   0,   0,  37,   0,   0,   0,
+     42,   0,   0,   0,  47,   0,   0,   0,  52,   0,   0,   0,  57,   0,   0,   0,
+     62,   0,   0,   0,  67,   0,   0,   0,  72,   0,   0,   0,  77,   0,   0,   0
+  },
+  {
+      3,   0,   0,   0,   8,   0,   0,   0,  13,   0,   0,   0,  18,   0,   0,   0,
+     23,   0,   0,   0,  28,   0,   0,   0,  33,   0,   0,   0,  38,   0,   0,   0,
+     43,   0,   0,   0,  48,   0,   0,   0,  53,   0,   0,   0,  58,   0,   0,   0,
+     63,   0,   0,   0,  68,   0,   0,   0,  73,   0,   0,   0,  78,   0,   0,   0
+  },
+  {
+      4,   0,   0,   0,   9,   0,   0,   0,  14,   0,   0,   0,  19,   0,   0,   0,
+     24,   0,   0,   0,  29,   0,   0,   0,  34,   0,   0,   0,  39,   0,   0,   0,
+     44,   0,   0,   0,  49,   0,   0,   0,  54,   0,   0,   0,  59,   0,   0,   0,
+     64,   0,   0,   0,  69,   0,   0,   0,  74,   0,   0,   0,  79,   0,   0,   0
+  }
+};
+
+/*******************************************************************************
+ * Name:  a85_filter_avx512
+ * Purpose: Like a85_filter_avx2(), but checks 64 bytes per step and compacts
+ *          them with vpcompressb.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,avx512vbmi,avx512vbmi2,popcnt")))
+static size_t a85_filter_avx512(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  uint8_t* pucDst = ptDec->aucChars + ptDec->sChars;
+  uint8_t* pucEnd = ptDec->aucChars + A85_BUFSIZE - 5 * 64;
+  __m512i  zMin   = _mm512_set1_epi8(A85_C_MIN);
+  __m512i  zMax   = _mm512_set1_epi8(A85_C_MAX);
+  __m512i  zNul   = _mm512_set1_epi8(A85_C_NUL);
+  __m512i  zEob   = _mm512_set1_epi8(A85_C_EOB);
+  size_t   i      = 0;
+
+  for (i = 0; i + 64 <= sLen && pucDst <= pucEnd; i += 64) {
+    __m512i   zIn = _mm512_loadu_si512((const void*) (pucIn + i));
+    __mmask64 kValid;
+
+    if (_mm512_cmpeq_epi8_mask(zIn, zNul) | _mm512_cmpeq_epi8_mask(zIn, zEob)) {
+      ptDec->sChars = pucDst - ptDec->aucChars;
+      size_t sDone  = a85_filter_scalar(ptDec, pucIn + i, 64);
+      pucDst        = ptDec->aucChars + ptDec->sChars;
+      if (ptDec->iState == A85_DEC_DONE) return i + sDone;
+      continue;
+    }
+
+    kValid = _mm512_cmpge_epu8_mask(zIn, zMin) & _mm512_cmple_epu8_mask(zIn, zMax);
+    _mm512_storeu_si512((void*) pucDst, _mm512_maskz_compress_epi8(kValid, zIn));
+    pucDst += __builtin_popcountll(kValid);
+  }
+
+  ptDec->sChars = pucDst - ptDec->aucChars;
+  return i + a85_filter_scalar(ptDec, pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_count_avx512
+ * Purpose: Like a85_count_avx2(), but with 64 bytes per step.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static size_t a85_count_avx512(const uint8_t* pucIn, size_t sLen) {
+  __m512i zMin   = _mm512_set1_epi8(A85_C_MIN);
+  __m512i zMax   = _mm512_set1_epi8(A85_C_MAX);
+  __m512i zNul   = _mm512_set1_epi8(A85_C_NUL);
+  size_t  sChars = 0;
+  size_t  i      = 0;
+
+  for (i = 0; i + 64 <= sLen; i += 64) {
+    __m512i zIn = _mm512_loadu_si512((const void*) (pucIn + i));
+    sChars += __builtin_popcountll(_mm512_cmpge_epu8_mask(zIn, zMin) & _mm512_cmple_epu8_mask(zIn, zMax));
+    sChars += 5 * __builtin_popcountll(_mm512_cmpeq_epi8_mask(zIn, zNul));
+  }
+
+  return sChars + a85_count_scalar(pucIn + i, sLen - i);
+}
+
+/*******************************************************************************
+ * Name:  a85_decode_avx512
+ * Purpose: Like a85_decode_avx2(), but sums up 16 groups. The digits are
+ *          gathered from 2 loads with vpermt2b, the 2nd one masked, so it
+ *          never reads behind the chars.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void a85_decode_avx512(uint8_t* pucOut, const uint8_t* pucChars, size_t sGroups) {
+  const __m512i zBswap = _mm512_broadcast_i32x4(
+                           _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+  const __m512i z33    = _mm512_set1_epi32(33);
+  const __m512i z85    = _mm512_set1_epi32(85);
+  __m512i       azIdx[5];
+  size_t        g      = 0;
+
+  for (int k = 0; k < 5; ++k)
+    azIdx[k] = _mm512_loadu_si512((const void*) a85_aucDecAvx512[k]);
+
+  for (g = 0; g + 16 <= sGroups; g += 16) {
+    const uint8_t* p    = pucChars + 5 * g;
+    __m512i        zA   = _mm512_loadu_si512((const void*) p);
+    __m512i        zB   = _mm512_maskz_loadu_epi8(0xffff, p + 64);
+    __m512i        zSum = _mm512_setzero_si512();
+
+    for (int k = 0; k < 5; ++k) {
+      __m512i zD = _mm512_maskz_permutex2var_epi8(0x1111111111111111ull, zA, azIdx[k], zB);
+      zSum = _mm512_add_epi32(_mm512_mullo_epi32(zSum, z85), _mm512_sub_epi32(zD, z33));
+    }
+    _mm512_storeu_si512((void*) (pucOut + 4 * g), _mm512_shuffle_epi8(zSum, zBswap));
+  }
+
+  a85_decode_scalar(pucOut + 4 * g, pucChars + 5 * g, sGroups - g);
+}
+
+#endif // A85_X86
+
+//*** decoder kernels
+//******************************************************************************
+
+
+//******************************************************************************
+//*** encoder kernels
+
+/*******************************************************************************
+ * Name:  a85_encode_scalar
+ * Purpose: Converts big-endian words into 5 chars each.
+ *          Divisions by 85 are done as multiplication with its reciprocal.
+ *******************************************************************************/
+static void a85_encode_scalar(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords) {
+  for (size_t w = 0; w < sWords; ++w) {
+    const uint8_t* b      = pucIn + 4 * w;
+    uint32_t       u32Int = (uint32_t) b[0] << 24 | (uint32_t) b[1] << 16
+                          | (uint32_t) b[2] <<  8 | (uint32_t) b[3];
+
+    // Get the 5 chars out of the integer, least significant first.
+    for (int i = 4; i >= 0; --i) {
+      uint32_t u32Quot = A85_DIV85(u32Int);
+      pucOut[5 * w + i] = (uint8_t) (u32Int - u32Quot * 85 + 33);
+      u32Int = u32Quot;
+    }
+  }
+}
+
+/*******************************************************************************
+ * Name:  a85_encode_lut
+ * Purpose: Like a85_encode_scalar(), but divides only twice and looks up the
+ *          char pairs of the 2 upper and the 2 middle digits.
+ *******************************************************************************/
+static void a85_encode_lut(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords) {
+  for (size_t w = 0; w < sWords; ++w) {
+    const uint8_t* b       = pucIn + 4 * w;
+    uint32_t       u32Int  = (uint32_t) b[0] << 24 | (uint32_t) b[1] << 16
+                           | (uint32_t) b[2] <<  8 | (uint32_t) b[3];
+    uint32_t       u32Quot = A85_DIV85(u32Int);
+    uint32_t       u32Hi   = u32Quot / (85 * 85);
+
+    memcpy(pucOut + 5 * w,     a85_aucEncPair[u32Hi], 2);
+    memcpy(pucOut + 5 * w + 2, a85_aucEncPair[u32Quot - u32Hi * 85 * 85], 2);
+    pucOut[5 * w + 4] = (uint8_t) (u32Int - u32Quot * 85 + 33);
+  }
+}
+
+#ifdef A85_X86
+
+/*******************************************************************************
+ * Name:  a85_div85_sse41
+ * Purpose: Divides 4 unsigned 32 bit lanes by 85 via reciprocal.
+ *******************************************************************************/
+__attribute__((target("sse4.1")))
+static inline __m128i a85_div85_sse41(__m128i xIn) {
+  const __m128i xMagic = _mm_set1_epi32((int) A85_DIV85_MAGIC);
+  __m128i       xEven  = _mm_srli_epi64(_mm_mul_epu32(xIn, xMagic), A85_DIV85_SHIFT);
+  __m128i       xOdd   = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(xIn, 32), xMagic), A85_DIV85_SHIFT);
+  return _mm_blend_epi16(xEven, _mm_slli_epi64(xOdd, 32), 0xcc);
+}
+
+/*******************************************************************************
+ * Name:  a85_encode_sse41
+ * Purpose: Like a85_encode_scalar(), but converts 4 words per step.
+ *          Digits are packed to bytes and shuffled into 4 groups of 5 chars.
+ *******************************************************************************/
+__attribute__((target("sse4.1")))
+static void a85_encode_sse41(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords) {
+  const __m128i xBswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  const __m128i x85    = _mm_set1_epi32(85);
+  const __m128i x33    = _mm_set1_epi8(33);
+  // Digit k of word j is byte 4k + j, last digits are in a 2nd register.
+  const __m128i xHead  = _mm_setr_epi8(0, 4, 8, 12, -1, 1, 5, 9, 13, -1, 2, 6, 10, 14, -1, 3);
+  const __m128i xHead4 = _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, -1, -1, 1, -1, -1, -1, -1, 2, -1);
+  const __m128i xTail  = _mm_setr_epi8(7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i xTail4 = _mm_setr_epi8(-1, -1, -1, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  size_t        w      = 0;
+
+  for (w = 0; w + 4 <= sWords; w += 4) {
+    __m128i xInt = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (pucIn + 4 * w)), xBswap);
+    __m128i xQ1  = a85_div85_sse41(xInt);
+    __m128i xQ2  = a85_div85_sse41(xQ1);
+    __m128i xQ3  = a85_div85_sse41(xQ2);
+    __m128i xQ4  = a85_div85_sse41(xQ3);
+    __m128i xD4  = _mm_sub_epi32(xInt, _mm_mullo_epi32(xQ1, x85));
+    __m128i xD3  = _mm_sub_epi32(xQ1,  _mm_mullo_epi32(xQ2, x85));
+    __m128i xD2  = _mm_sub_epi32(xQ2,  _mm_mullo_epi32(xQ3, x85));
+    __m128i xD1  = _mm_sub_epi32(xQ3,  _mm_mullo_epi32(xQ4, x85));
+    __m128i xA   = _mm_packus_epi16(_mm_packus_epi32(xQ4, xD1), _mm_packus_epi32(xD2, xD3));
+    __m128i xB   = _mm_packus_epi16(_mm_packus_epi32(xD4, xD4), xD4);
+    int32_t i32Tail;
+
+    xA = _mm_add_epi8(xA, x33);
+    xB = _mm_add_epi8(xB, x33);
+
+    _mm_storeu_si128((__m128i*) (pucOut + 5 * w),
+                     _mm_or_si128(_mm_shuffle_epi8(xA, xHead), _mm_shuffle_epi8(xB, xHead4)));
+    i32Tail = _mm_cvtsi128_si32(_mm_or_si128(_mm_shuffle_epi8(xA, xTail), _mm_shuffle_epi8(xB, xTail4)));
+    memcpy(pucOut + 5 * w + 16, &i32Tail, 4);
+  }
+
+  a85_encode_scalar(pucOut + 5 * w, pucIn + 4 * w, sWords - w);
+}
+
+/*******************************************************************************
+ * Name:  a85_div85_avx2
+ * Purpose: Divides 8 unsigned 32 bit lanes by 85 via reciprocal.
+ *******************************************************************************/
+__attribute__((target("avx2")))
+static inline __m256i a85_div85_avx2(__m256i yIn) {
+  const __m256i yMagic = _mm256_set1_epi32((int) A85_DIV85_MAGIC);
+  __m256i       yEven  = _mm256_srli_epi64(_mm256_mul_epu32(yIn, yMagic), A85_DIV85_SHIFT);
+  __m256i       yOdd   = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(yIn, 32), yMagic), A85_DIV85_SHIFT);
+  return _mm256_blend_epi32(yEven, _mm256_slli_epi64(yOdd, 32), 0xaa);
+}
+
+/*******************************************************************************
+ * Name:  a85_encode_avx2
+ * Purpose: Like a85_encode_sse41(), but with 8 words, 4 in each 128 bit lane.
+ *******************************************************************************/
+__attribute__((target("avx2")))
+static void a85_encode_avx2(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords) {
+  const __m256i yBswap = _mm256_broadcastsi128_si256(
+                           _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+  const __m256i y85    = _mm256_set1_epi32(85);
+  const __m256i y33    = _mm256_set1_epi8(33);
+  const __m256i yHead  = _mm256_broadcastsi128_si256(
+                           _mm_setr_epi8(0, 4, 8, 12, -1, 1, 5, 9, 13, -1, 2, 6, 10, 14, -1, 3));
+  const __m256i yHead4 = _mm256_broadcastsi128_si256(
+                           _mm_setr_epi8(-1, -1, -1, -1, 0, -1, -1, -1, -1, 1, -1, -1, -1, -1, 2, -1));
+  const __m256i yTail  = _mm256_broadcastsi128_si256(
+                           _mm_setr_epi8(7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+  const __m256i yTail4 = _mm256_broadcastsi128_si256(
+                           _mm_setr_epi8(-1, -1, -1, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+  size_t        w      = 0;
+
+  for (w = 0; w + 8 <= sWords; w += 8) {
+    __m256i yInt = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) (pucIn + 4 * w)), yBswap);
+    __m256i yQ1  = a85_div85_avx2(yInt);
+    __m256i yQ2  = a85_div85_avx2(yQ1);
+    __m256i yQ3  = a85_div85_avx2(yQ2);
+    __m256i yQ4  = a85_div85_avx2(yQ3);
+    __m256i yD4  = _mm256_sub_epi32(yInt, _mm256_mullo_epi32(yQ1, y85));
+    __m256i yD3  = _mm256_sub_epi32(yQ1,  _mm256_mullo_epi32(yQ2, y85));
+    __m256i yD2  = _mm256_sub_epi32(yQ2,  _mm256_mullo_epi32(yQ3, y85));
+    __m256i yD1  = _mm256_sub_epi32(yQ3,  _mm256_mullo_epi32(yQ4, y85));
+    __m256i yA   = _mm256_packus_epi16(_mm256_packus_epi32(yQ4, yD1), _mm256_packus_epi32(yD2, yD3));
+    __m256i yB   = _mm256_packus_epi16(_mm256_packus_epi32(yD4, yD4), yD4);
+    __m256i yHd;
+    __m256i yTl;
+    int32_t i32Tail;
+
+    yA  = _mm256_add_epi8(yA, y33);
+    yB  = _mm256_add_epi8(yB, y33);
+    yHd = _mm256_or_si256(_mm256_shuffle_epi8(yA, yHead), _mm256_shuffle_epi8(yB, yHead4));
+    yTl = _mm256_or_si256(_mm256_shuffle_epi8(yA, yTail), _mm256_shuffle_epi8(yB, yTail4));
+
+    _mm_storeu_si128((__m128i*) (pucOut + 5 * w), _mm256_castsi256_si128(yHd));
+    i32Tail = _mm_cvtsi128_si32(_mm256_castsi256_si128(yTl));
+    memcpy(pucOut + 5 * w + 16, &i32Tail, 4);
+    _mm_storeu_si128((__m128i*) (pucOut + 5 * w + 20), _mm256_extracti128_si256(yHd, 1));
+    i32Tail = _mm_cvtsi128_si32(_mm256_extracti128_si256(yTl, 1));
+    memcpy(pucOut + 5 * w + 36, &i32Tail, 4);
+  }
+
+  a85_encode_scalar(pucOut + 5 * w, pucIn + 4 * w, sWords - w);
+}
+
+
+/*******************************************************************************
+ * Name:  a85_div85_avx512
+ * Purpose: Divides 16 unsigned 32 bit lanes by 85 via reciprocal.
+ *******************************************************************************/
+__attribute__((target("avx512f")))
+static inline __m512i a85_div85_avx512(__m512i zIn) {
+  const __m512i zMagic = _mm512_set1_epi32((int) A85_DIV85_MAGIC);
+  __m512i       zEven  = _mm512_srli_epi64(_mm512_mul_epu32(zIn, zMagic), A85_DIV85_SHIFT);
+  __m512i       zOdd   = _mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(zIn, 32), zMagic), A85_DIV85_SHIFT);
+  return _mm512_mask_blend_epi32(0xaaaa, zEven, _mm512_slli_epi64(zOdd, 32));
+}
+
+// Position of each of 80 chars within the 5 digit vectors of 16 bytes, the
+// 5th vector is in the 2nd table of vpermt2b.
+static const uint8_t a85_aucEncAvx512[128] = {
+    0,  16,  32,  48,  64,   1,  17,  33,  49,  65,   2,  18,  34,  50,  66,   3,
+   19,  35,  51,  67,   4,  20,  36,  52,  68,   5,  21,  37,  53,  69,   6,  22,
+   38,  54,  70,   7,  23,  39,  55,  71,   8,  24,  40,  56,  72,   9,  25,  41,
+   57,  73,  10,  26,  42,  58,  74,  11,  27,  43,  59,  75,  12,  28,  44,  60,
+   76,  13,  29,  45,  61,  77,  14,  30,  46,  62,  78,  15,  31,  47,  63,  79,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+/*******************************************************************************
+ * Name:  a85_encode_avx512
+ * Purpose: Like a85_encode_avx2(), but converts 16 words. The digits are
+ *          narrowed to bytes and interleaved into 80 chars with vpermt2b.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void a85_encode_avx512(uint8_t* pucOut, const uint8_t* pucIn, size_t sWords) {
+  const __m512i zBswap = _mm512_broadcast_i32x4(
+                           _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+  const __m512i z85    = _mm512_set1_epi32(85);
+  const __m512i z33    = _mm512_set1_epi8(33);
+  const __m512i zIdxLo = _mm512_loadu_si512((const void*) a85_aucEncAvx512);
+  const __m512i zIdxHi = _mm512_loadu_si512((const void*) (a85_aucEncAvx512 + 64));
+  size_t        w      = 0;
+
+  for (w = 0; w + 16 <= sWords; w += 16) {
+    __m512i zInt = _mm512_shuffle_epi8(_mm512_loadu_si512((const void*) (pucIn + 4 * w)), zBswap);
+    __m512i zQ1  = a85_div85_avx512(zInt);
+    __m512i zQ2  = a85_div85_avx512(zQ1);
+    __m512i zQ3  = a85_div85_avx512(zQ2);
+    __m512i zQ4  = a85_div85_avx512(zQ3);
+    __m512i zD4  = _mm512_sub_epi32(zInt, _mm512_mullo_epi32(zQ1, z85));
+    __m512i zD3  = _mm512_sub_epi32(zQ1,  _mm512_mullo_epi32(zQ2, z85));
+    __m512i zD2  = _mm512_sub_epi32(zQ2,  _mm512_mullo_epi32(zQ3, z85));
+    __m512i zD1  = _mm512_sub_epi32(zQ3,  _mm512_mullo_epi32(zQ4, z85));
+    __m512i zA   = _mm512_inserti64x4(
+                     _mm512_castsi256_si512(_mm256_set_m128i(_mm512_cvtepi32_epi8(zD1),
+                                                             _mm512_cvtepi32_epi8(zQ4))),
+                     _mm256_set_m128i(_mm512_cvtepi32_epi8(zD3), _mm512_cvtepi32_epi8(zD2)), 1);
+    __m512i zB   = _mm512_castsi128_si512(_mm512_cvtepi32_epi8(zD4));
+
+    zA = _mm512_add_epi8(zA, z33);
+    zB = _mm512_add_epi8(zB, z33);
+    _mm512_storeu_si512((void*) (pucOut + 5 * w), _mm512_permutex2var_epi8(zA, zIdxLo, zB));
+    _mm_storeu_si128((__m128i*) (pucOut + 5 * w + 64),
+                     _mm512_castsi512_si128(_mm512_permutex2var_epi8(zA, zIdxHi, zB)));
+  }
+
+  a85_encode_scalar(pucOut + 5 * w, pucIn + 4 * w, sWords - w);
+}
+
+#endif // A85_X86
+
+//*** encoder kernels
+//******************************************************************************
+
+
+//******************************************************************************
+//*** kernel dispatch
+
+#ifdef A85_X86
+
+/*******************************************************************************
+ * Name:  a85_has_sse41
+ * Purpose: Checks via cpuid, if SSE4.1 kernels can run on this host.
+ *******************************************************************************/
+static int a85_has_sse41(void) {
+  return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("popcnt");
+}
+
+/*******************************************************************************
+ * Name:  a85_has_avx2
+ * Purpose: Checks via cpuid, if AVX2 kernels can run on this host.
+ *******************************************************************************/
+static int a85_has_avx2(void) {
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+/*******************************************************************************
+ * Name:  a85_has_avx512
+ * Purpose: Checks via cpuid, if AVX-512 kernels can run on this host. They
+ *          need byte permutes (VBMI) and compression (VBMI2) as well.
+ *******************************************************************************/
+static int a85_has_avx512(void) {
+  return __builtin_cpu_supports("avx512f")    && __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512vbmi2") &&
+         __builtin_cpu_supports("popcnt");
+}
+
+#endif // A85_X86
+
+/*******************************************************************************
+ * Name:  a85_has_scalar
+ * Purpose: Scalar kernels run everywhere.
+ *******************************************************************************/
+static int a85_has_scalar(void) {
+  return 1;
+}
+
+// All kernels, the last one supported by the host is the default.
+static t_a85kernel a85_atKernels[] = {
+  {"scalar", a85_has_scalar, a85_filter_scalar, a85_count_scalar, a85_decode_scalar, a85_encode_scalar},
+  {"lut",    a85_has_scalar, a85_filter_scalar, a85_count_scalar, a85_decode_lut,    a85_encode_lut},
+#ifdef A85_X86
+  {"sse4.1", a85_has_sse41,  a85_filter_sse41,  a85_count_sse41,  a85_decode_sse41,  a85_encode_sse41},
+  {"avx2",   a85_has_avx2,   a85_filter_avx2,   a85_count_avx2,   a85_decode_avx2,   a85_encode_avx2},
+  {"avx512", a85_has_avx512, a85_filter_avx512, a85_count_avx512, a85_decode_avx512, a85_encode_avx512},
+#endif
+};
+
+// Kernels in use for decoding and for encoding.
+static t_a85kernel* a85_ptKernel    = &a85_atKernels[0];
+static t_a85kernel* a85_ptEncKernel = &a85_atKernels[0];
+
+/*******************************************************************************
+ * Name:  a85_find_kernel
+ * Purpose: Returns kernel by name or the fastest one supported by this host,
+ *          if name is empty. Returns NULL, if kernel is unknown or unsupported.
+ *******************************************************************************/
+static t_a85kernel* a85_find_kernel(const char* pcName) {
+  t_a85kernel* ptKernel = NULL;
+
+#ifdef A85_X86
+  a85_init_compact_table();
+#endif
+  a85_init_pair_tables();
+
+  for (size_t i = 0; i < sizeof(a85_atKernels) / sizeof(a85_atKernels[0]); ++i) {
+    if (! a85_atKernels[i].isSupported()) continue;
+    if (pcName[0] == 0 || ! strcmp(pcName, a85_atKernels[i].pcName))
+      ptKernel = &a85_atKernels[i];
+  }
+
+  return ptKernel;
+}
+
+//*** kernel dispatch
+//******************************************************************************
+
+
+//******************************************************************************
+//*** decoder
+
+/*******************************************************************************
+ * Name:  a85_find_payload_start
+ * Purpose: Scans chunk for '<~' with memchr(). A '<' at the chunk's end is
+ *          kept as state. Returns count of consumed bytes.
+ *******************************************************************************/
+static size_t a85_find_payload_start(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  const uint8_t* pucLt = NULL;
+  size_t         i     = 0;
+
+  if (ptDec->iState == A85_DEC_SEEK_LT && sLen > 0) {
+    if (pucIn[0] == '~') {
+      ptDec->iState = A85_DEC_DATA;
+      return 1;
+    }
+    ptDec->iState = A85_DEC_SEEK;
+  }
+
+  while (i < sLen) {
+    if (! (pucLt = memchr(pucIn + i, '<', sLen - i))) return sLen;
+    i = pucLt - pucIn + 1;
+    if (i == sLen) {
+      ptDec->iState = A85_DEC_SEEK_LT;
+      return sLen;
+    }
+    if (pucIn[i] == '~') {
+      ptDec->iState = A85_DEC_DATA;
+      return i + 1;
+    }
+  }
+  return sLen;
+}
+
+/*******************************************************************************
+ * Name:  a85_skip_block
+ * Purpose: Scans chunk for the '~' of a block not to be decoded.
+ *          Returns count of consumed bytes.
+ *******************************************************************************/
+static size_t a85_skip_block(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen) {
+  const uint8_t* pucEob = memchr(pucIn, A85_C_EOB, sLen);
+
+  if (! pucEob) return sLen;
+
+  ptDec->iState = A85_DEC_SEEK;
+  return pucEob - pucIn + 1;
+}
+
+/*******************************************************************************
+ * Name:  a85_clip
+ * Purpose: Clips decoded bytes to the wanted range. Returns count of bytes
+ *          left at the start of the buffer.
+ *******************************************************************************/
+static size_t a85_clip(t_a85dec* ptDec, uint8_t* pucOut, size_t sLen) {
+  size_t sDrop = 0;
+
+  if (ptDec->oDrop > 0) {
+    sDrop = (ptDec->oDrop < (off_t) sLen) ? (size_t) ptDec->oDrop : sLen;
+    ptDec->oDrop -= sDrop;
+    sLen         -= sDrop;
+    memmove(pucOut, pucOut + sDrop, sLen);
+  }
+  if (ptDec->oLeft >= 0) {
+    if ((off_t) sLen > ptDec->oLeft) sLen = ptDec->oLeft;
+    ptDec->oLeft -= sLen;
+  }
+
+  return sLen;
+}
+
+/*******************************************************************************
+ * Name:  a85_flush_groups
+ * Purpose: Decodes all complete groups of the char buffer and keeps the rest.
+ *          Returns count of bytes put out.
+ *******************************************************************************/
+static size_t a85_flush_groups(t_a85dec* ptDec, uint8_t* pucOut) {
+  size_t sStart  = 0;
+  size_t sGroups = 0;
+  size_t sRest   = 0;
+
+  // Drop chars before given offset.
+  if (ptDec->oSkip > 0) {
+    sStart = (ptDec->oSkip < (off_t) ptDec->sChars) ? (size_t) ptDec->oSkip : ptDec->sChars;
+    ptDec->oSkip -= sStart;
+  }
+
+  sGroups = (ptDec->sChars - sStart) / 5;
+  sRest   = (ptDec->sChars - sStart) % 5;
+
+  a85_ptKernel->decode(pucOut, ptDec->aucChars + sStart, sGroups);
+
+  // Carry partial group to next chunk.
+  memmove(ptDec->aucChars, ptDec->aucChars + sStart + 5 * sGroups, sRest);
+  ptDec->sChars = sRest;
+
+  return a85_clip(ptDec, pucOut, 4 * sGroups);
+}
+
+/*******************************************************************************
+ * Name:  a85_finish_group
+ * Purpose: Pads last partial group with 'u' and puts out its remaining bytes.
+ *          Returns count of bytes put out.
+ *******************************************************************************/
+static size_t a85_finish_group(t_a85dec* ptDec, uint8_t* pucOut) {
+  size_t sRest = ptDec->sChars;
+
+  // Padding is like follows:
+  // Chars:   0 1 2 3 4 5 6 7 8 9 10
+  // Padding: 0 4 3 2 1 0 4 3 2 1 0
+  if (sRest == 0) return 0;
+
+  for (size_t i = sRest; i < 5; ++i) ptDec->aucChars[i] = A85_C_MAX;
+
+  a85_ptKernel->decode(pucOut, ptDec->aucChars, 1);
+  ptDec->sChars = 0;
+
+  return a85_clip(ptDec, pucOut, sRest - 1);
+}
+
+/*******************************************************************************
+ * Name:  a85_end_block
+ * Purpose: Finishes a block, reports it and decides, whether to look for more
+ *          blocks. Returns count of bytes put out.
+ *******************************************************************************/
+static size_t a85_end_block(t_a85dec* ptDec, off_t oEob, uint8_t* pucOut) {
+  size_t sOut = 0;
+
+  if (ptDec->pfBlock) ptDec->pfBlock(ptDec->pvUser, ptDec->iBlock, ptDec->oBlockBeg, oEob);
+
+  if (ptDec->iState == A85_DEC_DONE) sOut = a85_finish_group(ptDec, pucOut);
+
+  ++ptDec->iBlock;
+  if (ptDec->iWant < 0) ptDec->iState = A85_DEC_SEEK;
+
+  return sOut;
+}
+
+//*** decoder
+//******************************************************************************
+
+
+//******************************************************************************
+//*** encoder
+
+/*******************************************************************************
+ * Name:  a85_pack_zeros
+ * Purpose: Replaces the '!!!!!' of each zero word by 'z' in place. Returns
+ *          count of chars left. Chars before the first zero word stay put.
+ *******************************************************************************/
+static size_t a85_pack_zeros(uint8_t* pucChars, const uint8_t* pucIn, size_t sWords) {
+  uint32_t u32Word = 0;
+  size_t   sOut    = 0;
+  size_t   w       = 0;
+
+  // Most blocks have no zero words at all.
+  for (w = 0; w < sWords; ++w) {
+    memcpy(&u32Word, pucIn + 4 * w, 4);
+    if (u32Word == 0) break;
+  }
+
+  for (sOut = 5 * w; w < sWords; ++w) {
+    memcpy(&u32Word, pucIn + 4 * w, 4);
+    if (u32Word == 0) {
+      pucChars[sOut++] = A85_C_NUL;
+      continue;
+    }
+    memmove(pucChars + sOut, pucChars + 5 * w, 5);
+    sOut += 5;
+  }
+
+  return sOut;
+}
+
+/*******************************************************************************
+ * Name:  a85_wrap
+ * Purpose: Copies chars with a newline after each full line. Returns count of
+ *          bytes put out.
+ *******************************************************************************/
+static size_t a85_wrap(t_a85enc* ptEnc, const uint8_t* pucChars, size_t sLen, uint8_t* pucOut) {
+  size_t sWrap = ptEnc->iWrap;
+  size_t sPos  = 0;
+  size_t sOut  = 0;
+  size_t sPart = 0;
+
+  if (sWrap == 0) {
+    memcpy(pucOut, pucChars, sLen);
+    return sLen;
+  }
+
+  // Newline is set before the next char, so none follows the last line.
+  while (sPos < sLen) {
+    if (ptEnc->sCol == sWrap) {
+      pucOut[sOut++] = '\n';
+      ptEnc->sCol = 0;
+    }
+    sPart = (sWrap - ptEnc->sCol < sLen - sPos) ? sWrap - ptEnc->sCol : sLen - sPos;
+    memcpy(pucOut + sOut, pucChars + sPos, sPart);
+    sOut        += sPart;
+    sPos        += sPart;
+    ptEnc->sCol += sPart;
+  }
+
+  return sOut;
+}
+
+/*******************************************************************************
+ * Name:  a85_encode_words
+ * Purpose: Encodes full words with the selected kernel, packs zero words and
+ *          wraps lines. Returns count of bytes put out.
+ *******************************************************************************/
+static size_t a85_encode_words(t_a85enc* ptEnc, const uint8_t* pucIn, size_t sWords, uint8_t* pucOut) {
+  size_t sChars = 5 * sWords;
+
+  a85_ptEncKernel->encode(ptEnc->aucChars, pucIn, sWords);
+  if (! ptEnc->iNoZero) sChars = a85_pack_zeros(ptEnc->aucChars, pucIn, sWords);
+
+  return a85_wrap(ptEnc, ptEnc->aucChars, sChars, pucOut);
+}
+
+//*** encoder
+//******************************************************************************
+
+
+//******************************************************************************
+//* public functions
+
+/*******************************************************************************
+ * Name:  a85SelectKernel
+ * Purpose: Selects kernel for decoding and encoding by name or the fastest one
+ *          supported by this host, if name is empty. Returns 0, if kernel is
+ *          unknown or unsupported.
+ *******************************************************************************/
+int a85SelectKernel(const char* pcName) {
+  return a85SelectDecKernel(pcName) && a85SelectEncKernel(pcName);
+}
+
+/*******************************************************************************
+ * Name:  a85SelectDecKernel
+ * Purpose: Like a85SelectKernel(), but for decoding and counting only.
+ *******************************************************************************/
+int a85SelectDecKernel(const char* pcName) {
+  t_a85kernel* ptKernel = a85_find_kernel(pcName);
+
+  if (ptKernel) a85_ptKernel = ptKernel;
+  return ptKernel != NULL;
+}
+
+/*******************************************************************************
+ * Name:  a85SelectEncKernel
+ * Purpose: Like a85SelectKernel(), but for encoding only.
+ *******************************************************************************/
+int a85SelectEncKernel(const char* pcName) {
+  t_a85kernel* ptKernel = a85_find_kernel(pcName);
+
+  if (ptKernel) a85_ptEncKernel = ptKernel;
+  return ptKernel != NULL;
+}
+
+/*******************************************************************************
+ * Name:  a85KernelCount
+ * Purpose: Returns count of all kernels built in, supported or not.
+ *******************************************************************************/
+int a85KernelCount(void) {
+  return (int) (sizeof(a85_atKernels) / sizeof(a85_atKernels[0]));
+}
+
+/*******************************************************************************
+ * Name:  a85KernelName
+ * Purpose: Returns name of kernel with given index.
+ *******************************************************************************/
+const char* a85KernelName(int iKernel) {
+  return a85_atKernels[iKernel].pcName;
+}
+
+/*******************************************************************************
+ * Name:  a85KernelSupported
+ * Purpose: Returns 1, if kernel with given index runs on this host.
+ *******************************************************************************/
+int a85KernelSupported(int iKernel) {
+  return a85_atKernels[iKernel].isSupported();
+}
+
+/*******************************************************************************
+ * Name:  a85KernelInUse
+ * Purpose: Returns name of kernel selected for decoding.
+ *******************************************************************************/
+const char* a85KernelInUse(void) {
+  return a85_ptKernel->pcName;
+}
+
+/*******************************************************************************
+ * Name:  a85EncKernelInUse
+ * Purpose: Returns name of kernel selected for encoding.
+ *******************************************************************************/
+const char* a85EncKernelInUse(void) {
+  return a85_ptEncKernel->pcName;
+}
+
+/*******************************************************************************
+ * Name:  a85FindPayload
+ * Purpose: Returns pointer behind the next '<~', or NULL if there is none.
+ *******************************************************************************/
+const uint8_t* a85FindPayload(const uint8_t* pucIn, const uint8_t* pucEnd) {
+  while (pucIn < pucEnd && (pucIn = memchr(pucIn, '<', pucEnd - pucIn)))
+    if (++pucIn < pucEnd && *pucIn == '~') return pucIn + 1;
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  a85Count
+ * Purpose: Counts valid chars of a payload without '~', 'z' counts 5 chars.
+ *******************************************************************************/
+size_t a85Count(const uint8_t* pucIn, size_t sLen) {
+  return a85_ptKernel->count(pucIn, sLen);
+}
+
+/*******************************************************************************
+ * Name:  a85DecInit
+ * Purpose: Sets decoder to decode the first block found completely.
+ *******************************************************************************/
+void a85DecInit(t_a85dec* ptDec) {
+  ptDec->iWant     = 0;
+  ptDec->oSkip     = 0;
+  ptDec->oDrop     = 0;
+  ptDec->oLeft     = -1;
+  ptDec->oPos      = 0;
+  ptDec->iBlock    = 0;
+  ptDec->pfBlock   = NULL;
+  ptDec->pvUser    = NULL;
+  ptDec->iState    = A85_DEC_SEEK;
+  ptDec->oBlockBeg = 0;
+  ptDec->sChars    = 0;
+}
+
+/*******************************************************************************
+ * Name:  a85DecBound
+ * Purpose: Returns size of output buffer needed to feed sLen bytes, as each
+ *          'z' is decoded to 4 bytes.
+ *******************************************************************************/
+size_t a85DecBound(size_t sLen) {
+  return 4 * sLen + 4;
+}
+
+/*******************************************************************************
+ * Name:  a85DecSeek
+ * Purpose: Continues decoding within the payload of the current block, whose
+ *          '<~' is at oBlockBeg. Next fed chunk is at oPos and its first
+ *          oSkip valid chars are skipped.
+ *******************************************************************************/
+void a85DecSeek(t_a85dec* ptDec, off_t oBlockBeg, off_t oPos, off_t oSkip) {
+  ptDec->iState    = A85_DEC_DATA;
+  ptDec->oBlockBeg = oBlockBeg;
+  ptDec->oPos      = oPos;
+  ptDec->oSkip     = oSkip;
+  ptDec->sChars    = 0;
+}
+
+/*******************************************************************************
+ * Name:  a85DecFeed
+ * Purpose: Decodes a chunk of any size with the selected kernel. Blocks not
+ *          wanted are skipped. Returns count of bytes put out.
+ *******************************************************************************/
+size_t a85DecFeed(t_a85dec* ptDec, const uint8_t* pucIn, size_t sLen, uint8_t* pucOut) {
+  size_t sPos = 0;
+  size_t sOut = 0;
+
+  while (sPos < sLen && ptDec->iState != A85_DEC_DONE && ptDec->oLeft != 0) {
+    if (ptDec->iState == A85_DEC_SEEK || ptDec->iState == A85_DEC_SEEK_LT) {
+      sPos += a85_find_payload_start(ptDec, pucIn + sPos, sLen - sPos);
+      if (ptDec->iState != A85_DEC_DATA) continue;
+
+      // Found '<~', decode or skip this block.
+      ptDec->oBlockBeg = ptDec->oPos + sPos - 2;
+      if (ptDec->iWant != A85_BLOCK_ALL && ptDec->iWant != ptDec->iBlock)
+        ptDec->iState = A85_DEC_SKIP;
+      continue;
+    }
+    if (ptDec->iState == A85_DEC_SKIP) {
+      sPos += a85_skip_block(ptDec, pucIn + sPos, sLen - sPos);
+      if (ptDec->iState == A85_DEC_SEEK)
+        sOut += a85_end_block(ptDec, ptDec->oPos + sPos - 1, pucOut + sOut);
+      continue;
+    }
+    sPos += a85_ptKernel->filter(ptDec, pucIn + sPos, sLen - sPos);
+    sOut += a85_flush_groups(ptDec, pucOut + sOut);
+    if (ptDec->iState == A85_DEC_DONE)
+      sOut += a85_end_block(ptDec, ptDec->oPos + sPos - 1, pucOut + sOut);
+  }
+
+  ptDec->oPos += sLen;
+  return sOut;
+}
+
+/*******************************************************************************
+ * Name:  a85DecFinishChunk
+ * Purpose: Completes the partial group of a chunk decoded on its own with just
+ *          enough chars of the bytes following it, or pads it, if the payload
+ *          ends before. Returns count of bytes put out.
+ *******************************************************************************/
+size_t a85DecFinishChunk(t_a85dec* ptDec, const uint8_t* pucNext, size_t sLen, uint8_t* pucOut) {
+  if (ptDec->sChars == 0) return 0;
+
+  for (size_t i = 0; i < sLen && ptDec->sChars % 5; ++i) {
+    uint8_t c = pucNext[i];
+    if (c == A85_C_NUL) {
+      // A 'z' may reach into the next group, take its first chars only.
+      while (ptDec->sChars % 5) ptDec->aucChars[ptDec->sChars++] = A85_C_MIN;
+      continue;
+    }
+    if (c < A85_C_MIN || c > A85_C_MAX) continue;
+    ptDec->aucChars[ptDec->sChars++] = c;
+  }
+
+  if (ptDec->sChars % 5 == 0) return a85_flush_groups(ptDec, pucOut);
+  return a85_finish_group(ptDec, pucOut);
+}
+
+/*******************************************************************************
+ * Name:  a85DecFinish
+ * Purpose: Checks decoder after the last chunk. Returns A85_OK, if the wanted
+ *          blocks were complete, else one of A85_ERR_*.
+ *******************************************************************************/
+int a85DecFinish(const t_a85dec* ptDec) {
+  // Range is complete or blocks were only listed.
+  if (ptDec->oLeft == 0 || ptDec->iWant == A85_BLOCK_NONE) return A85_OK;
+
+  if (ptDec->iState == A85_DEC_DATA || ptDec->iState == A85_DEC_SKIP) return A85_ERR_NO_EOB;
+  if (ptDec->iBlock == 0)                                             return A85_ERR_NO_BLOCK;
+  if (ptDec->iWant >= 0 && ptDec->iState != A85_DEC_DONE)            return A85_ERR_NOT_FOUND;
+
+  return A85_OK;
+}
+
+/*******************************************************************************
+ * Name:  a85EncInit
+ * Purpose: Sets encoder to write 'z' for zero words and no newlines.
+ *******************************************************************************/
+void a85EncInit(t_a85enc* ptEnc) {
+  ptEnc->iWrap    = 0;
+  ptEnc->iNoZero  = 0;
+  ptEnc->iStarted = 0;
+  ptEnc->sCol     = 0;
+  ptEnc->sLast    = 0;
+}
+
+/*******************************************************************************
+ * Name:  a85EncBound
+ * Purpose: Returns size of output buffer needed to feed sLen bytes, or to
+ *          finish with sLen = 0. Newlines take at most half as much again.
+ *******************************************************************************/
+size_t a85EncBound(size_t sLen) {
+  return 2 * (5 * (sLen / 4 + 2) + 4);
+}
+
+/*******************************************************************************
+ * Name:  a85EncFeed
+ * Purpose: Encodes a chunk of any size with the selected kernel. Up to 3 bytes
+ *          are kept for the next chunk. Returns count of bytes put out.
+ *******************************************************************************/
+size_t a85EncFeed(t_a85enc* ptEnc, const uint8_t* pucIn, size_t sLen, uint8_t* pucOut) {
+  size_t sOut   = 0;
+  size_t sWords = 0;
+
+  if (! ptEnc->iStarted) {
+    sOut += a85_wrap(ptEnc, (const uint8_t*) "<~", 2, pucOut);
+    ptEnc->iStarted = 1;
+  }
+
+  // Complete the word kept from last chunk.
+  if (ptEnc->sLast > 0) {
+    while (ptEnc->sLast < 4 && sLen > 0) {
+      ptEnc->aucLast[ptEnc->sLast++] = *pucIn++;
+      --sLen;
+    }
+    if (ptEnc->sLast < 4) return sOut;
+    sOut += a85_encode_words(ptEnc, ptEnc->aucLast, 1, pucOut + sOut);
+    ptEnc->sLast = 0;
+  }
+
+  // Convert all full words block by block.
+  while ((sWords = sLen / 4) > 0) {
+    if (sWords > A85_ENC_WORDS) sWords = A85_ENC_WORDS;
+    sOut  += a85_encode_words(ptEnc, pucIn, sWords, pucOut + sOut);
+    pucIn += 4 * sWords;
+    sLen  -= 4 * sWords;
+  }
+
+  memcpy(ptEnc->aucLast, pucIn, sLen);
+  ptEnc->sLast = sLen;
+
+  return sOut;
+}
+
+/*******************************************************************************
+ * Name:  a85EncFinish
+ * Purpose: Pads the incomplete word and puts out the '~>'. Returns count of
+ *          bytes put out.
+ *******************************************************************************/
+size_t a85EncFinish(t_a85enc* ptEnc, uint8_t* pucOut) {
+  size_t sOut = 0;
+
+  if (! ptEnc->iStarted) {
+    sOut += a85_wrap(ptEnc, (const uint8_t*) "<~", 2, pucOut);
+    ptEnc->iStarted = 1;
+  }
+
+  // Padding is like follows:
+  // Chars:   0 1 2 3 4 5 6 7 8
+  // Padding: 0 3 2 1 0 3 2 1 0
+  if (ptEnc->sLast > 0) {
+    memset(ptEnc->aucLast + ptEnc->sLast, 0, 4 - ptEnc->sLast);
+    a85_encode_scalar(ptEnc->aucChars, ptEnc->aucLast, 1);
+    sOut += a85_wrap(ptEnc, ptEnc->aucChars, ptEnc->sLast + 1, pucOut + sOut);
+    ptEnc->sLast = 0;
+  }
+
+  // Keep '~>' on one line.
+  if (ptEnc->iWrap && ptEnc->sCol + 2 > (size_t) ptEnc->iWrap) ptEnc->sCol = ptEnc->iWrap;
+  sOut += a85_wrap(ptEnc, (const uint8_t*) "~>", 2, pucOut + sOut);
+
+  return sOut;
+}
+
+
+#endif // C_ASCII85_H
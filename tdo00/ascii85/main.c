@@ -14,6 +14,25 @@
  ** 20.10.2020  JE    Changed ftell() and fseek() to 64 bit type now use off_t.
  ** 20.10.2020  JE    Changed all size_t to off_t accordingly.
  ** 12.08.2023  JE    Now uses 'c_dynamic_arrays_macros.h' and latest libs.
+ ** 17.10.2026  JE    Decoder now streams chunks with constant memory usage.
+ ** 17.10.2026  JE    Added SSE4.1 and AVX2 decoder kernels, selected via cpuid.
+ ** 17.10.2026  JE    Added '--kernel' and '--bench' for kernel throughput.
+ ** 17.10.2026  JE    Added SSE4.1 and AVX2 encoder kernels without divisions.
+ ** 17.10.2026  JE    Added '-j' to decode a payload with several threads.
+ ** 17.10.2026  JE    Now '-j' also converts several files at once in order.
+ ** 17.10.2026  JE    Added '-m' to limit bytes buffered by threads.
+ ** 17.10.2026  JE    Added '-a', '--block' and '-l' for files with many blocks.
+ ** 17.10.2026  JE    Now '-o' is a byte offset only, it skipped payload too.
+ ** 17.10.2026  JE    Added '-i' for a sidecar index of blocks and char counts.
+ ** 17.10.2026  JE    Added '--range' to decode only some bytes of a block.
+ ** 17.10.2026  JE    Encoder now writes 'z' for zero words, '--no-z' to not.
+ ** 17.10.2026  JE    Added '-w' to wrap encoded lines.
+ ** 17.10.2026  JE    Moved codec into lib 'c_ascii85.h', usable by other tools.
+ ** 17.10.2026  JE    Encoder now streams chunks with constant memory usage.
+ ** 17.10.2026  JE    Added '--digest' and '--verify' to hash output instead.
+ ** 17.10.2026  JE    Added 'lut' and 'avx512' kernels and '--calibrate'.
+ ** 17.10.2026  JE    Now '-m' also holds back files smaller than a flush.
+ ** 17.10.2026  JE    Now errors of '-j' print all files before the failing one.
  *******************************************************************************/
 
 
@@ -24,15 +43,21 @@
 #include <stdio.h>            // ... now use 64 bit with ftello() and fseeko().
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <openssl/evp.h>
 
 #include "c_string.h"
 #include "c_dynamic_arrays_macros.h"
+#include "c_ascii85.h"
 
 
 //******************************************************************************
 //* me and myself
 
-#define ME_VERSION "0.3.3"
+#define ME_VERSION "0.16.1"
 cstr g_csMename;
 
 
@@ -48,11 +73,45 @@ cstr g_csMename;
 #define sERR_FILE  "File error"
 #define sERR_ELSE  "Unknown error"
 
-// ASCII85 special chars.
-#define C_MIN ('!')
-#define C_MAX ('u')
-#define C_NUL ('z')
-#define C_EOB ('~')
+// Bytes per chunk of parallel decoder and its passes.
+#define PAR_CHUNK  (4 * 1024 * 1024)
+#define PAR_COUNT  0x00
+#define PAR_DECODE 0x01
+
+// Buffered bytes of a file being converted in parallel before flushing
+// and default limit of bytes buffered for all files.
+#define SINK_FLUSH   (1024 * 1024)
+#define MAX_BUFFERED (64 * 1024 * 1024)
+
+// Sidecar index: checkpoints every chunk of the parallel decoder, bytes hashed
+// at both ends of a file for its key.
+#define IDX_SUFFIX  ".a85i"
+#define IDX_MAGIC   "a85idx"
+#define IDX_VERSION 1
+#define IDX_STEP    PAR_CHUNK
+#define IDX_HASHED  (64 * 1024)
+
+// FNV-1a 64 bit.
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME  0x00000100000001b3ull
+
+// Digests of the output stream.
+#define DIG_NONE   0x00
+#define DIG_SHA256 0x01
+#define DIG_XXH64  0x02
+
+// XXH64 primes.
+#define XXH_P1 0x9e3779b185ebca87ull
+#define XXH_P2 0xc2b2ae3d27d4eb4full
+#define XXH_P3 0x165667b19e3779f9ull
+#define XXH_P4 0x85ebca77c2b2ae63ull
+#define XXH_P5 0x27d4eb2f165667c5ull
+
+// Size of ascii85 test data for benchmark.
+#define BENCH_SIZE (64 * 1024 * 1024)
+
+// Kernels chosen by '--calibrate', in '$XDG_CONFIG_HOME' or '$HOME/.config'.
+#define CFG_NAME "ascii85.conf"
 
 
 //******************************************************************************
@@ -68,8 +127,22 @@ cstr g_csMename;
 typedef struct s_options {
   int   iPrtEol;
   int   iEncode;
+  int   iNoZero;
+  int   iWrap;
   off_t oOffset;
   int   iReadStdin;
+  int   iThreads;
+  off_t oMaxBuf;
+  int   iBlock;
+  int   iList;
+  int   iIndex;
+  off_t oRangeBeg;
+  off_t oRangeLen;  // -1 for no range.
+  int   iBench;
+  int   iCalibrate;
+  cstr  csKernel;
+  int   iDigest;   // DIG_*, output is hashed instead of printed.
+  cstr  csVerify;  // Expected digest in hex, if any.
 } t_options;
 
 // For conversion of int32 into its bytes and vice versa.
@@ -78,8 +151,88 @@ typedef union s_i32c {
   uchar    aChars[4];
 } t_i32c;
 
+// XXH64 state, keeps bytes of an incomplete stripe.
+typedef struct s_xxh64 {
+  uint64_t au64Acc[4];
+  uint64_t u64Total;
+  uchar    aucMem[32];
+  size_t   sMem;
+} t_xxh64;
+
+// Digest of the output stream.
+typedef struct s_digest {
+  EVP_MD_CTX* ptCtx;  // SHA-256.
+  t_xxh64     tXxh;
+} t_digest;
+
+// Converted bytes go to a file or into a buffer.
+typedef struct s_sink {
+  FILE*          hFile;     // Write to this file, if set.
+  uchar*         pucBuf;    // Else append to this buffer.
+  size_t         sLen;
+  size_t         sCap;
+  struct s_jobs* ptJobs;    // Buffer belongs to a file of a parallel run.
+  size_t         sIndex;    // Index of that file.
+  size_t         sCounted;  // Bytes already counted as buffered.
+} t_sink;
+
+// Files converted by several threads, printed in argument order.
+typedef struct s_jobs {
+  pthread_mutex_t tMutex;
+  pthread_cond_t  tCond;
+  size_t          sFiles;
+  size_t          sNextJob;   // Next file to be taken by a thread.
+  size_t          sHead;      // First file not completely printed.
+  size_t          sBuffered;  // Bytes buffered of all files.
+  size_t          sMaxBuf;    // Files behind head wait above this.
+  int*            piDone;
+  t_sink*         ptOut;
+} t_jobs;
+
+// Part of a payload decoded by one thread.
+typedef struct s_chunk {
+  const uchar* pucBeg;  // Bytes of chunk.
+  const uchar* pucEnd;
+  size_t       sFirst;  // Char offset of chunk within payload.
+  size_t       sNext;   // Char offset of next chunk.
+  t_sink       tOut;    // Decoded bytes.
+  int          iDone;
+} t_chunk;
+
+// Threads working on all chunks of a payload.
+typedef struct s_pool {
+  pthread_mutex_t tMutex;
+  pthread_cond_t  tCond;
+  int             iPass;      // PAR_COUNT or PAR_DECODE.
+  t_chunk*        ptChunks;
+  size_t          sChunks;
+  size_t          sNextJob;   // Next chunk to be taken by a thread.
+  size_t          sWritten;   // Chunks already printed.
+  size_t          sWindow;    // Max chunks decoded ahead of printing.
+  const uchar*    pucPayEnd;  // The payload's '~'.
+} t_pool;
+
+// Block of a sidecar index.
+typedef struct s_idxblk {
+  off_t  oBeg;    // Offset of '<~'.
+  off_t  oEob;    // Offset of '~' of '~>'.
+  size_t sFirst;  // First checkpoint of block.
+  size_t sCount;  // Checkpoints of block, one per IDX_STEP payload bytes.
+} t_idxblk;
+
 s_array(cstr);
-s_array(int);
+s_array(uchar);
+s_array(size_t);
+s_array(t_idxblk);
+
+// Sidecar index of a file, valid as long as the file's key matches.
+typedef struct s_index {
+  off_t              oSize;
+  ll                 llMtime;  // Nanoseconds.
+  uint64_t           u64Hash;  // Of first and last IDX_HASHED bytes.
+  t_array(t_idxblk)  tBlocks;
+  t_array(size_t)    tChars;   // Valid chars of payload up to each step's end.
+} t_index;
 
 
 //******************************************************************************
@@ -89,6 +242,12 @@ s_array(int);
 t_options     g_tOpts;  // CLI options and arguments.
 t_array(cstr) g_tArgs;  // Free arguments.
 
+// Digest of output instead of printing it.
+t_digest g_tDigest;
+
+// Sink of the file a thread converts, errors wait for its turn to print.
+__thread t_sink* g_ptJobSink = NULL;
+
 
 //******************************************************************************
 //* Functions
@@ -106,7 +265,12 @@ void usage(int iErr, const char* pcMsg) {
 
   csSetf(&csMsg, "%s"
 //|************************ 80 chars width ****************************************|
-  "usage: %s [-n] [-e] [-o n] file1 [file2 ...]\n"
+  "usage: %s [-n] [-e] [-o n] [-j n] [-m n] [--kernel name] file1 [file2 ...]\n"
+  "       %s [-a|--block n|-l] [-i] [-o n] [-j n] [-m n] file1 [file2 ...]\n"
+  "       %s [--block n] [-i] [--range s:n] file\n"
+  "       %s -e [-w n] [--no-z] [-o n] file1 [file2 ...]\n"
+  "       %s [--digest sha256|xxh64] [--verify hex] [-e] file1 [file2 ...]\n"
+  "       %s [--bench|--calibrate] [--kernel name]\n"
   "       %s [-h|--help|-v|--version]\n"
   " Reads file(s) and prints ascii85 decoded/encoded data to stdout.\n"
   " Data can also been piped into the program. Examples:\n"
@@ -116,12 +280,39 @@ void usage(int iErr, const char* pcMsg) {
   "   <~ARTY*$3~>\n"
   "  -n:            print a newline after conversion\n"
   "  -e:            encode bytes to ascii85 (default decodes to bytes)\n"
+  "  -w n:          wrap encoded lines after n chars, n > 1 (default 0 = off)\n"
+  "  --no-z:        don't encode zero words as 'z'\n"
   "  -o n:          set byte offset where file(s) start to be read\n"
+  "  -a:            decode all '<~ ... ~>' blocks (default first one only)\n"
+  "  --block n:     decode block n only, counting from 0\n"
+  "  -l:            print index, byte offset and length of all blocks, use the\n"
+  "                 offset with '-o' to start at a block directly\n"
+  "  --range s:n:   print n decoded bytes of block from byte s on, decodes\n"
+  "                 only the groups needed, '-i' seeks to the first one\n"
+  "  -i:            use index file '<file>.a85i' to seek blocks directly and\n"
+  "                 to skip counting chars with '-j', written if missing or\n"
+  "                 outdated\n"
+  "  -j n:          convert files with n threads, output keeps file order, a\n"
+  "                 single file's payload is decoded in chunks (default 1)\n"
+  "  -m n:          bytes of converted files buffered ahead of the file being\n"
+  "                 printed, when using threads (default 64M)\n"
+  "  --kernel name: use kernel 'scalar', 'lut', 'sse4.1', 'avx2' or 'avx512'\n"
+  "                 (default is the calibrated or else the newest one\n"
+  "                 supported by this CPU)\n"
+  "  --digest name: print digest 'sha256' or 'xxh64' of all output instead of\n"
+  "                 the output itself, '-n' is ignored\n"
+  "  --verify hex:  check digest of all output and fail on mismatch, digest is\n"
+  "                 taken from '--digest' or the length of hex\n"
+  "  --bench:       print speed of all kernels supported by this CPU\n"
+  "  --calibrate:   like '--bench', but saves the fastest kernels for decoding\n"
+  "                 and encoding to '~/.config/" CFG_NAME "'\n"
   "  -h|--help:     print this help\n"
   "  -v|--version:  print version of program\n"
 //|************************ 80 chars width ****************************************|
          ,csMsg.cStr,
-         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr
+         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr,
+         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr,
+         g_csMename.cStr
         );
 
   if (iErr == ERR_NOERR)
@@ -134,6 +325,12 @@ void usage(int iErr, const char* pcMsg) {
   exit(iErr);
 }
 
+/*******************************************************************************
+ * Name:  failJob
+ * Purpose: Needed as a forward declaration for 'dispatchError()'.
+ *******************************************************************************/
+void failJob(t_sink* ptSink);
+
 /*******************************************************************************
  * Name:  dispatchError
  * Purpose: Print out specific error message, if any occurres.
@@ -151,6 +348,9 @@ void dispatchError(int rv, const char* pcMsg) {
   // Set to '<err>: <message>', if a message was given.
   if (csMsg.len != 0) csSetf(&csErr, "%s: %s", csErr.cStr, csMsg.cStr);
 
+  // Print all files before a failing one first, like without threads.
+  if (g_ptJobSink) failJob(g_ptJobSink);
+
   usage(rv, csErr.cStr);
 }
 
@@ -162,6 +362,7 @@ void getOptions(int argc, char* argv[]) {
   cstr csArgv = csNew("");
   cstr csRv   = csNew("");
   cstr csOpt  = csNew("");
+  cstr csLen  = csNew("");
   int  iArg   = 1;  // Omit program name in arg loop.
   int  iChar  = 0;
   char cOpt   = 0;
@@ -169,8 +370,22 @@ void getOptions(int argc, char* argv[]) {
   // Set defaults.
   g_tOpts.iPrtEol    = 0;
   g_tOpts.iEncode    = 0;
+  g_tOpts.iNoZero    = 0;
+  g_tOpts.iWrap      = 0;
   g_tOpts.oOffset    = 0;
   g_tOpts.iReadStdin = 0;
+  g_tOpts.iThreads   = 1;
+  g_tOpts.oMaxBuf    = MAX_BUFFERED;
+  g_tOpts.iBlock     = 0;
+  g_tOpts.iList      = 0;
+  g_tOpts.iIndex     = 0;
+  g_tOpts.oRangeBeg  = 0;
+  g_tOpts.oRangeLen  = -1;
+  g_tOpts.iBench     = 0;
+  g_tOpts.iCalibrate = 0;
+  g_tOpts.csKernel   = csNew("");
+  g_tOpts.iDigest    = DIG_NONE;
+  g_tOpts.csVerify   = csNew("");
 
   // Init free argument's dynamic array.
   daInit(cstr, g_tArgs);
@@ -190,6 +405,51 @@ next_argument:
       if (!strcmp(csArgv.cStr, "--version")) {
         version();
       }
+      if (!strcmp(csArgv.cStr, "--block")) {
+        if (! getArgInt(&g_tOpts.iBlock, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No valid block index or missing");
+        if (g_tOpts.iBlock < 0) dispatchError(ERR_ARGS, "Block index < 0");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--range")) {
+        if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL) ||
+            csSplit(&csOpt, &csLen, csRv.cStr, ":") == CS_INSTR_NOT_FOUND ||
+            ! getArgHexLong((ll*) &g_tOpts.oRangeBeg, NULL, 0, NULL, ARG_VAL, csOpt.cStr) ||
+            ! getArgHexLong((ll*) &g_tOpts.oRangeLen, NULL, 0, NULL, ARG_VAL, csLen.cStr))
+          dispatchError(ERR_ARGS, "No valid range 'start:length' or missing");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--no-z")) {
+        g_tOpts.iNoZero = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--digest")) {
+        if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No digest given");
+        if      (!strcmp(csRv.cStr, "sha256")) g_tOpts.iDigest = DIG_SHA256;
+        else if (!strcmp(csRv.cStr, "xxh64"))  g_tOpts.iDigest = DIG_XXH64;
+        else dispatchError(ERR_ARGS, "Digest unknown");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--verify")) {
+        if (! getArgStr(&g_tOpts.csVerify, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No digest to verify given");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--bench")) {
+        g_tOpts.iBench = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--calibrate")) {
+        g_tOpts.iBench     = 1;
+        g_tOpts.iCalibrate = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--kernel")) {
+        if (! getArgStr(&g_tOpts.csKernel, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No kernel given");
+        continue;
+      }
       dispatchError(ERR_ARGS, "Invalid long option");
     }
 
@@ -211,11 +471,38 @@ next_argument:
           g_tOpts.iEncode = 1;
           continue;
         }
+        if (cOpt == 'w') {
+          if (! getArgInt(&g_tOpts.iWrap, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid wrap width or missing");
+          continue;
+        }
+        if (cOpt == 'a') {
+          g_tOpts.iBlock = A85_BLOCK_ALL;
+          continue;
+        }
+        if (cOpt == 'l') {
+          g_tOpts.iList = 1;
+          continue;
+        }
+        if (cOpt == 'i') {
+          g_tOpts.iIndex = 1;
+          continue;
+        }
         if (cOpt == 'o') {
           if (! getArgHexLong((ll*) &g_tOpts.oOffset, &iArg, argc, argv, ARG_CLI, NULL))
             dispatchError(ERR_ARGS, "No valid offset or missing");
           continue;
         }
+        if (cOpt == 'm') {
+          if (! getArgHexLong((ll*) &g_tOpts.oMaxBuf, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid buffer size or missing");
+          continue;
+        }
+        if (cOpt == 'j') {
+          if (! getArgInt(&g_tOpts.iThreads, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid thread count or missing");
+          continue;
+        }
         dispatchError(ERR_ARGS, "Invalid short option");
       }
       goto next_argument;
@@ -225,7 +512,28 @@ next_argument:
   }
 
   // Sanity check of arguments and flags.
-  if (g_tOpts.oOffset < 0) dispatchError(ERR_ARGS, "Offset < 0");
+  if (g_tOpts.oOffset  < 0) dispatchError(ERR_ARGS, "Offset < 0");
+  if (g_tOpts.iThreads < 1) dispatchError(ERR_ARGS, "Thread count < 1");
+  if (g_tOpts.oMaxBuf  < 0) dispatchError(ERR_ARGS, "Buffer size < 0");
+  if (g_tOpts.iWrap < 0 || g_tOpts.iWrap == 1)
+    dispatchError(ERR_ARGS, "Wrap width < 2");
+  if (g_tOpts.oRangeBeg < 0 || (g_tOpts.oRangeLen < 0 && g_tOpts.oRangeLen != -1))
+    dispatchError(ERR_ARGS, "Range start or length < 0");
+  if (g_tOpts.oRangeLen >= 0 &&
+      (g_tOpts.iEncode || g_tOpts.iList || g_tOpts.iBlock == A85_BLOCK_ALL))
+    dispatchError(ERR_ARGS, "Range can't be used with '-e', '-l' or '-a'");
+
+  // Digest to verify needs no '--digest', if its length tells.
+  if (g_tOpts.csVerify.len != 0 && g_tOpts.iDigest == DIG_NONE) {
+    if (g_tOpts.csVerify.len == 2 * 32) g_tOpts.iDigest = DIG_SHA256;
+    if (g_tOpts.csVerify.len == 2 *  8) g_tOpts.iDigest = DIG_XXH64;
+  }
+  if (g_tOpts.csVerify.len != 0 &&
+      g_tOpts.csVerify.len != ((g_tOpts.iDigest == DIG_SHA256) ? 2 * 32 : 2 * 8))
+    dispatchError(ERR_ARGS, "Digest to verify has wrong length");
+
+  // A digest is a line on its own anyway.
+  if (g_tOpts.iDigest != DIG_NONE) g_tOpts.iPrtEol = 0;
 
   // Switch to stdin if no files were given.
   if (g_tArgs.sCount  == 0) g_tOpts.iReadStdin = 1;
@@ -234,118 +542,510 @@ next_argument:
   csFree(&csArgv);
   csFree(&csRv);
   csFree(&csOpt);
+  csFree(&csLen);
 }
 
 //******************************************************************************
-//*** decoder
+//*** digest
 
 /*******************************************************************************
- * Name:  readASCII852Array
- * Purpose: Reads all chars between '<~' & '~>' into array, skips whitespaces.
+ * Name:  xxh64Round
+ * Purpose: Mixes a word of input into an accumulator.
  *******************************************************************************/
-int readAscii852array(t_array(int)* pdaiBytes, FILE* hFile) {
-  int b = 0;
+uint64_t xxh64Round(uint64_t u64Acc, uint64_t u64In) {
+  u64Acc += u64In * XXH_P2;
+  u64Acc  = (u64Acc << 31) | (u64Acc >> 33);
+  return u64Acc * XXH_P1;
+}
 
-  // Read bytes until '<~' appears.
-  while (fread(&b, sizeof(char), 1, hFile)) {
-    if (b != '<') continue;
-    fread(&b, sizeof(char), 1, hFile);
-    if (b == '~') break;
+/*******************************************************************************
+ * Name:  xxh64Rotl
+ * Purpose: Rotates left by n bits, 0 < n < 64.
+ *******************************************************************************/
+uint64_t xxh64Rotl(uint64_t u64, int n) {
+  return (u64 << n) | (u64 >> (64 - n));
+}
+
+/*******************************************************************************
+ * Name:  xxh64Read
+ * Purpose: Reads n little endian bytes into a word.
+ *******************************************************************************/
+uint64_t xxh64Read(const uchar* pucIn, int n) {
+  uint64_t u64 = 0;
+  for (int i = n - 1; i >= 0; --i) u64 = (u64 << 8) | pucIn[i];
+  return u64;
+}
+
+/*******************************************************************************
+ * Name:  initXxh64
+ * Purpose: Sets XXH64 state for seed 0.
+ *******************************************************************************/
+void initXxh64(t_xxh64* ptXxh) {
+  ptXxh->au64Acc[0] = XXH_P1 + XXH_P2;
+  ptXxh->au64Acc[1] = XXH_P2;
+  ptXxh->au64Acc[2] = 0;
+  ptXxh->au64Acc[3] = -XXH_P1;
+  ptXxh->u64Total   = 0;
+  ptXxh->sMem       = 0;
+}
+
+/*******************************************************************************
+ * Name:  updateXxh64
+ * Purpose: Hashes all complete 32 byte stripes, keeps the rest for later.
+ *******************************************************************************/
+void updateXxh64(t_xxh64* ptXxh, const uchar* pucIn, size_t sLen) {
+  size_t sPart = 0;
+
+  ptXxh->u64Total += sLen;
+
+  // Complete the stripe kept from last time.
+  if (ptXxh->sMem > 0) {
+    sPart = (32 - ptXxh->sMem < sLen) ? 32 - ptXxh->sMem : sLen;
+    memcpy(ptXxh->aucMem + ptXxh->sMem, pucIn, sPart);
+    ptXxh->sMem += sPart;
+    pucIn       += sPart;
+    sLen        -= sPart;
+    if (ptXxh->sMem < 32) return;
+    for (int i = 0; i < 4; ++i)
+      ptXxh->au64Acc[i] = xxh64Round(ptXxh->au64Acc[i], xxh64Read(ptXxh->aucMem + 8 * i, 8));
+    ptXxh->sMem = 0;
+  }
+
+  for (; sLen >= 32; pucIn += 32, sLen -= 32)
+    for (int i = 0; i < 4; ++i)
+      ptXxh->au64Acc[i] = xxh64Round(ptXxh->au64Acc[i], xxh64Read(pucIn + 8 * i, 8));
+
+  memcpy(ptXxh->aucMem, pucIn, sLen);
+  ptXxh->sMem = sLen;
+}
+
+/*******************************************************************************
+ * Name:  finishXxh64
+ * Purpose: Returns the XXH64 of all bytes hashed.
+ *******************************************************************************/
+uint64_t finishXxh64(const t_xxh64* ptXxh) {
+  const uint64_t* pu64Acc = ptXxh->au64Acc;
+  const uchar*    pucMem  = ptXxh->aucMem;
+  size_t          sMem    = ptXxh->sMem;
+  uint64_t        u64Hash = XXH_P5;
+
+  if (ptXxh->u64Total >= 32) {
+    u64Hash = xxh64Rotl(pu64Acc[0],  1) + xxh64Rotl(pu64Acc[1],  7) +
+              xxh64Rotl(pu64Acc[2], 12) + xxh64Rotl(pu64Acc[3], 18);
+    for (int i = 0; i < 4; ++i) {
+      u64Hash ^= xxh64Round(0, pu64Acc[i]);
+      u64Hash  = u64Hash * XXH_P1 + XXH_P4;
+    }
   }
+  u64Hash += ptXxh->u64Total;
 
-  // Save to array until '~' appears (i.e. "~>")
-  while (fread(&b, sizeof(char), 1, hFile)) {
-    if (b == C_EOB)              return 1;
-    if (b == C_NUL)              for (int i = 0; i < 5; ++i) daAdd(int, (*pdaiBytes), C_MIN);
-    if (b <  C_MIN || b > C_MAX) continue;
-    daAdd(int, (*pdaiBytes), b);
+  for (; sMem >= 8; pucMem += 8, sMem -= 8) {
+    u64Hash ^= xxh64Round(0, xxh64Read(pucMem, 8));
+    u64Hash  = xxh64Rotl(u64Hash, 27) * XXH_P1 + XXH_P4;
   }
+  if (sMem >= 4) {
+    u64Hash ^= xxh64Read(pucMem, 4) * XXH_P1;
+    u64Hash  = xxh64Rotl(u64Hash, 23) * XXH_P2 + XXH_P3;
+    pucMem  += 4;
+    sMem    -= 4;
+  }
+  for (; sMem > 0; ++pucMem, --sMem) {
+    u64Hash ^= *pucMem * XXH_P5;
+    u64Hash  = xxh64Rotl(u64Hash, 11) * XXH_P1;
+  }
+
+  // Avalanche.
+  u64Hash ^= u64Hash >> 33;
+  u64Hash *= XXH_P2;
+  u64Hash ^= u64Hash >> 29;
+  u64Hash *= XXH_P3;
+  u64Hash ^= u64Hash >> 32;
+
+  return u64Hash;
+}
 
+/*******************************************************************************
+ * Name:  initDigest
+ * Purpose: Starts digest of output, if wanted.
+ *******************************************************************************/
+void initDigest(void) {
+  if (g_tOpts.iDigest == DIG_XXH64) initXxh64(&g_tDigest.tXxh);
+
+  if (g_tOpts.iDigest == DIG_SHA256) {
+    if (! (g_tDigest.ptCtx = EVP_MD_CTX_new()) ||
+        EVP_DigestInit_ex(g_tDigest.ptCtx, EVP_sha256(), NULL) != 1)
+      dispatchError(ERR_ELSE, "EVP_DigestInit_ex() failed");
+  }
+}
+
+/*******************************************************************************
+ * Name:  updateDigest
+ * Purpose: Hashes bytes of output.
+ *******************************************************************************/
+void updateDigest(const uchar* pucBytes, size_t sLen) {
+  if (g_tOpts.iDigest == DIG_XXH64) updateXxh64(&g_tDigest.tXxh, pucBytes, sLen);
+
+  if (g_tOpts.iDigest == DIG_SHA256)
+    if (EVP_DigestUpdate(g_tDigest.ptCtx, pucBytes, sLen) != 1)
+      dispatchError(ERR_ELSE, "EVP_DigestUpdate() failed");
+}
+
+/*******************************************************************************
+ * Name:  finishDigest
+ * Purpose: Prints digest of output or checks it against the given one.
+ *******************************************************************************/
+void finishDigest(void) {
+  uchar        aucMd[EVP_MAX_MD_SIZE];
+  unsigned int uiLen = 0;
+  uint64_t     u64   = 0;
+  char         acHex[2 * EVP_MAX_MD_SIZE + 1] = {0};
+
+  if (g_tOpts.iDigest == DIG_XXH64) {
+    u64 = finishXxh64(&g_tDigest.tXxh);
+    for (uiLen = 0; uiLen < 8; ++uiLen) aucMd[uiLen] = u64 >> (56 - 8 * uiLen);
+  }
+
+  if (g_tOpts.iDigest == DIG_SHA256) {
+    if (EVP_DigestFinal_ex(g_tDigest.ptCtx, aucMd, &uiLen) != 1)
+      dispatchError(ERR_ELSE, "EVP_DigestFinal_ex() failed");
+    EVP_MD_CTX_free(g_tDigest.ptCtx);
+  }
+
+  for (unsigned int i = 0; i < uiLen; ++i) sprintf(acHex + 2 * i, "%02x", aucMd[i]);
+
+  if (g_tOpts.csVerify.len == 0)
+    printf("%s\n", acHex);
+  else if (strcasecmp(acHex, g_tOpts.csVerify.cStr))
+    dispatchError(ERR_FILE, "Digest mismatch");
+}
+
+//*** digest
+//******************************************************************************
+
+
+//******************************************************************************
+//*** output sink
+
+/*******************************************************************************
+ * Name:  initSink
+ * Purpose: Sink writes to given file, or appends to its buffer if NULL.
+ *******************************************************************************/
+void initSink(t_sink* ptSink, FILE* hFile) {
+  ptSink->hFile    = hFile;
+  ptSink->pucBuf   = NULL;
+  ptSink->sLen     = 0;
+  ptSink->sCap     = 0;
+  ptSink->ptJobs   = NULL;
+  ptSink->sIndex   = 0;
+  ptSink->sCounted = 0;
+}
+
+/*******************************************************************************
+ * Name:  writeOut
+ * Purpose: Prints bytes to the output file, or hashes them only, if a digest
+ *          is wanted. All output passes here in order.
+ *******************************************************************************/
+void writeOut(FILE* hFile, const uchar* pucBytes, size_t sLen) {
+  if (g_tOpts.iDigest != DIG_NONE) {
+    updateDigest(pucBytes, sLen);
+    return;
+  }
+  fwrite(pucBytes, 1, sLen, hFile);
+}
+
+/*******************************************************************************
+ * Name:  flushJobSink
+ * Purpose: Needed as a forward declaration for 'writeSink()'.
+ *******************************************************************************/
+void flushJobSink(t_sink* ptSink);
+
+/*******************************************************************************
+ * Name:  writeSink
+ * Purpose: Writes bytes to the sink's file or appends them to its buffer.
+ *******************************************************************************/
+void writeSink(t_sink* ptSink, const uchar* pucBytes, size_t sLen) {
+  if (ptSink->hFile) {
+    writeOut(ptSink->hFile, pucBytes, sLen);
+    return;
+  }
+
+  if (ptSink->sLen + sLen > ptSink->sCap) {
+    while (ptSink->sLen + sLen > ptSink->sCap)
+      ptSink->sCap = (ptSink->sCap == 0) ? A85_BUFSIZE : 2 * ptSink->sCap;
+    ptSink->pucBuf = (uchar*) realloc(ptSink->pucBuf, ptSink->sCap);
+    if (! ptSink->pucBuf) dispatchError(ERR_ELSE, "Out of memory");
+  }
+  memcpy(ptSink->pucBuf + ptSink->sLen, pucBytes, sLen);
+  ptSink->sLen += sLen;
+
+  if (ptSink->ptJobs && ptSink->sLen >= SINK_FLUSH) flushJobSink(ptSink);
+}
+
+/*******************************************************************************
+ * Name:  freeSink
+ * Purpose: Frees the sink's buffer.
+ *******************************************************************************/
+void freeSink(t_sink* ptSink) {
+  free(ptSink->pucBuf);
+  ptSink->pucBuf   = NULL;
+  ptSink->sLen     = 0;
+  ptSink->sCap     = 0;
+  ptSink->sCounted = 0;
+}
+
+//*** output sink
+//******************************************************************************
+
+
+//******************************************************************************
+//*** kernel dispatch
+
+/*******************************************************************************
+ * Name:  getConfigName
+ * Purpose: Sets path of config file. Returns 0, if there is no home.
+ *******************************************************************************/
+int getConfigName(cstr* pcsName) {
+  const char* pcDir = getenv("XDG_CONFIG_HOME");
+
+  if (pcDir && pcDir[0] != 0) {
+    csSetf(pcsName, "%s/%s", pcDir, CFG_NAME);
+    return 1;
+  }
+  if ((pcDir = getenv("HOME")) && pcDir[0] != 0) {
+    csSetf(pcsName, "%s/.config/%s", pcDir, CFG_NAME);
+    return 1;
+  }
   return 0;
 }
 
 /*******************************************************************************
- * Name:  padArrayTo5
- * Purpose: Pads array with 'u' so its length is a multiple of 5.
+ * Name:  getCpuName
+ * Purpose: Sets model name of CPU, so a config shared by several hosts only
+ *          applies to those it was calibrated on.
  *******************************************************************************/
-int padArrayTo5(t_array(int)* pdaiBytes) {
-  int iPad = 5 - (pdaiBytes->sCount) % 5;
+void getCpuName(cstr* pcsCpu) {
+  FILE* hFile  = fopen("/proc/cpuinfo", "r");
+  cstr  csLine = csNew("");
+  cstr  csKey  = csNew("");
 
-  if (iPad == 5) return 0;
+  csSet(pcsCpu, "unknown");
 
-  // Padding is like follows:
-  // Chars:   0 1 2 3 4 5 6 7 8 9 10
-  // Padding: 0 4 3 2 1 0 4 3 2 1 0
+  while (hFile && ! feof(hFile) && csReadLine(&csLine, hFile)) {
+    if (csSplit(&csKey, pcsCpu, csLine.cStr, ": ") == CS_INSTR_NOT_FOUND) continue;
+    if (! strncmp(csKey.cStr, "model name", 10)) break;
+    csSet(pcsCpu, "unknown");
+  }
 
-  for (int i = 0; i < iPad; ++i)
-    daAdd(int, (*pdaiBytes), C_MAX);
+  if (hFile) fclose(hFile);
+  csFree(&csLine);
+  csFree(&csKey);
+}
 
-  return iPad;
+/*******************************************************************************
+ * Name:  readKernelConfig
+ * Purpose: Gets kernels for decoding and encoding from config file. Returns
+ *          0, if there is none or it was calibrated on another CPU.
+ *******************************************************************************/
+int readKernelConfig(cstr* pcsDec, cstr* pcsEnc) {
+  cstr  csName = csNew("");
+  cstr  csCpu  = csNew("");
+  cstr  csLine = csNew("");
+  cstr  csKey  = csNew("");
+  cstr  csVal  = csNew("");
+  FILE* hFile  = NULL;
+  int   iOk    = 0;
+
+  if (! getConfigName(&csName) || ! (hFile = fopen(csName.cStr, "r"))) goto done;
+  getCpuName(&csCpu);
+
+  // Lines are 'key value', '#' starts a comment.
+  while (! feof(hFile) && csReadLine(&csLine, hFile)) {
+    if (csLine.cStr[0] == '#') continue;
+    if (csSplit(&csKey, &csVal, csLine.cStr, " ") == CS_INSTR_NOT_FOUND) continue;
+    if (! strcmp(csKey.cStr, "cpu"))    iOk = ! strcmp(csVal.cStr, csCpu.cStr);
+    if (! strcmp(csKey.cStr, "decode")) csSet(pcsDec, csVal.cStr);
+    if (! strcmp(csKey.cStr, "encode")) csSet(pcsEnc, csVal.cStr);
+  }
+  fclose(hFile);
+
+done:
+  csFree(&csName);
+  csFree(&csCpu);
+  csFree(&csLine);
+  csFree(&csKey);
+  csFree(&csVal);
+  return iOk;
 }
 
 /*******************************************************************************
- * Name:  get4IntFrom5Block
- * Purpose: Converts 5 bytes into a 4 byte integer.
+ * Name:  writeKernelConfig
+ * Purpose: Saves kernels for decoding and encoding of this CPU.
  *******************************************************************************/
-void get4IntFrom5Block(uint32_t* puInt32, t_array(int)* pdaiBytes, off_t* poOff) {
-  int n[5] = {0};
+void writeKernelConfig(const char* pcDec, const char* pcEnc) {
+  cstr  csName = csNew("");
+  cstr  csCpu  = csNew("");
+  cstr  csDir  = csNew("");
+  FILE* hFile  = NULL;
+
+  if (! getConfigName(&csName))
+    dispatchError(ERR_FILE, "No home directory for config file");
 
-  // Read 5 bytes from array.
-  for (int i = 0; i < 5; ++i)
-    n[i] = pdaiBytes->pVal[*poOff + i];
+  // Create config directory, if missing.
+  csMid(&csDir, csName.cStr, 0, csInStrRev(CS_INSTR_START, csName.cStr, "/"));
+  mkdir(csDir.cStr, 0755);
 
-  // Calculation of 4 Bytes from five chars.
-  *puInt32 = (n[0] - 33) * 85 * 85 * 85 * 85
-           + (n[1] - 33) * 85 * 85 * 85
-           + (n[2] - 33) * 85 * 85
-           + (n[3] - 33) * 85
-           + (n[4] - 33);
+  if (! (hFile = fopen(csName.cStr, "w")))
+    dispatchError(ERR_FILE, "Can't write config file");
 
-  *poOff += 5;
+  getCpuName(&csCpu);
+  fprintf(hFile, "# Fastest kernels, written by '%s --calibrate'.\n", g_csMename.cStr);
+  fprintf(hFile, "cpu %s\n",    csCpu.cStr);
+  fprintf(hFile, "decode %s\n", pcDec);
+  fprintf(hFile, "encode %s\n", pcEnc);
+  fclose(hFile);
+
+  printf("Saved decode '%s' and encode '%s' to '%s'\n", pcDec, pcEnc, csName.cStr);
+
+  csFree(&csName);
+  csFree(&csCpu);
+  csFree(&csDir);
 }
 
 /*******************************************************************************
- * Name:  print4int
- * Purpose: Prints the int as 4 bytes little-endian.
+ * Name:  selectKernel
+ * Purpose: Selects kernel by name, else the calibrated ones or the newest one
+ *          supported by this host. Calibrated kernels unknown to this build
+ *          are left at the default.
  *******************************************************************************/
-void print4int(uint32_t u32Int, int iMax) {
-  t_i32c ui32c = {0};
+void selectKernel(const char* pcName) {
+  cstr csDec = csNew("");
+  cstr csEnc = csNew("");
+
+  if (! a85SelectKernel(pcName))
+    dispatchError(ERR_ARGS, "Kernel unknown or not supported by this CPU");
 
-  ui32c.u32Int = u32Int;
-  for (int i = 0; i < iMax; ++i) {
-    printf("%c", ui32c.aChars[3 - i]);
+  if (pcName[0] == 0 && readKernelConfig(&csDec, &csEnc)) {
+    if (csDec.len != 0) a85SelectDecKernel(csDec.cStr);
+    if (csEnc.len != 0) a85SelectEncKernel(csEnc.cStr);
   }
+
+  csFree(&csDec);
+  csFree(&csEnc);
+}
+
+//*** kernel dispatch
+//******************************************************************************
+
+
+//******************************************************************************
+//*** decoder
+
+/*******************************************************************************
+ * Name:  printBlockLine
+ * Purpose: Prints index, offset of '<~' and length through '~>' of a block to
+ *          the sink given as pvOut.
+ *******************************************************************************/
+void printBlockLine(void* pvOut, int iBlock, off_t oBeg, off_t oEob) {
+  cstr csLine = csNew("");
+
+  csSetf(&csLine, "%d %lld %lld\n", iBlock, (ll) oBeg, (ll) (oEob + 2 - oBeg));
+  writeSink((t_sink*) pvOut, (const uchar*) csLine.cStr, csLine.len);
+
+  csFree(&csLine);
+}
+
+/*******************************************************************************
+ * Name:  findIndexBlock
+ * Purpose: Returns position of given block in index, counting from the first
+ *          block behind offset, or -1, if index has no such block.
+ *******************************************************************************/
+ll findIndexBlock(const t_index* ptIdx, int iBlock) {
+  size_t b = 0;
+
+  while (b < ptIdx->tBlocks.sCount && ptIdx->tBlocks.pVal[b].oBeg < g_tOpts.oOffset) ++b;
+  b += iBlock;
+
+  return (b < ptIdx->tBlocks.sCount) ? (ll) b : -1;
 }
 
 /*******************************************************************************
  * Name:  ascii852bin
- * Purpose: Converts an ascii84 data stream to a byte stream.
+ * Purpose: Converts an ascii85 data stream to a byte stream chunk by chunk.
+ *          With an index, it seeks to the wanted block instead of scanning,
+ *          or even to the checkpoint before a wanted range.
  *******************************************************************************/
-void ascii852bin(FILE* hFile) {
-  uint32_t     uInt32   = {0};
-  t_array(int) daiBytes = {0};
-  off_t        oOff     = g_tOpts.oOffset;
-  int          iPad     = 0;
-  int          iN       = 4;
+void ascii852bin(FILE* hFile, const t_index* ptIdx, t_sink* ptOut) {
+  t_a85dec        tDec   = {0};
+  const t_idxblk* ptBlk  = NULL;
+  uchar*          pucIn  = NULL;
+  uchar*          pucOut = NULL;
+  size_t          sRead  = 0;
+  size_t          c      = 0;
+  ll              llBlk  = -1;
+  off_t           oSkip  = 0;
+
+  a85DecInit(&tDec);
+  tDec.iWant = g_tOpts.iBlock;
+  tDec.oPos  = g_tOpts.oOffset;
+
+  // List blocks only.
+  if (g_tOpts.iList) {
+    tDec.iWant   = A85_BLOCK_NONE;
+    tDec.pfBlock = printBlockLine;
+    tDec.pvUser  = ptOut;
+  }
 
-  daInit(int, daiBytes);
+  // Skip chars of all groups before range, their bytes are not decoded.
+  if (g_tOpts.oRangeLen >= 0) {
+    tDec.oSkip = 5 * (g_tOpts.oRangeBeg / 4);
+    tDec.oDrop = g_tOpts.oRangeBeg % 4;
+    tDec.oLeft = g_tOpts.oRangeLen;
+  }
 
-  if (! readAscii852array(&daiBytes, hFile))
-    dispatchError(ERR_FILE, "Error reading file");
+  // Index lists all blocks behind offset already.
+  if (ptIdx && g_tOpts.iList) {
+    llBlk = findIndexBlock(ptIdx, 0);
+    for (ll b = llBlk; b >= 0 && b < (ll) ptIdx->tBlocks.sCount; ++b)
+      printBlockLine(ptOut, b - llBlk, ptIdx->tBlocks.pVal[b].oBeg, ptIdx->tBlocks.pVal[b].oEob);
+    tDec.iState = A85_DEC_DONE;
+  }
+
+  // Seek to wanted or first block, the scan starts at its '<~'.
+  if (ptIdx && ! g_tOpts.iList) {
+    llBlk = findIndexBlock(ptIdx, (tDec.iWant == A85_BLOCK_ALL) ? 0 : tDec.iWant);
+    if (llBlk >= 0) {
+      tDec.oPos   = ptIdx->tBlocks.pVal[llBlk].oBeg;
+      tDec.iBlock = (tDec.iWant == A85_BLOCK_ALL) ? 0 : tDec.iWant;
+
+      // Start inside payload at last step with fewer chars than to skip.
+      ptBlk = &ptIdx->tBlocks.pVal[llBlk];
+      while (c + 1 < ptBlk->sCount && ptIdx->tChars.pVal[ptBlk->sFirst + c] <= tDec.oSkip) ++c;
+      if (tDec.oSkip > 0 && c > 0) {
+        oSkip = tDec.oSkip - ptIdx->tChars.pVal[ptBlk->sFirst + c - 1];
+        a85DecSeek(&tDec, ptBlk->oBeg, ptBlk->oBeg + 2 + c * IDX_STEP, oSkip);
+      }
+      fseeko(hFile, tDec.oPos, SEEK_SET);
+    }
+  }
 
-  iPad = padArrayTo5(&daiBytes);
+  pucIn  = (uchar*) malloc(A85_BUFSIZE);
+  pucOut = (uchar*) malloc(a85DecBound(A85_BUFSIZE));
 
-  while(1) {
-    get4IntFrom5Block(&uInt32, &daiBytes, &oOff);
-    if (oOff == daiBytes.sCount) iN = 4 - iPad;
-    print4int(uInt32, iN);
-    if (oOff >= daiBytes.sCount) break;
+  while (tDec.iState != A85_DEC_DONE && tDec.oLeft != 0 && (sRead = fread(pucIn, 1, A85_BUFSIZE, hFile)) > 0)
+    writeSink(ptOut, pucOut, a85DecFeed(&tDec, pucIn, sRead, pucOut));
+
+  // No '~>' found, no block at all or not the wanted one, unless range is done.
+  switch (a85DecFinish(&tDec)) {
+    case A85_ERR_NO_BLOCK:
+    case A85_ERR_NO_EOB:    dispatchError(ERR_FILE, "Error reading file"); break;
+    case A85_ERR_NOT_FOUND: dispatchError(ERR_FILE, "Block not found");    break;
   }
 
   // Print an end of line, if wanted.
-  if(g_tOpts.iPrtEol) printf("\n");
+  if(g_tOpts.iPrtEol) writeSink(ptOut, (const uchar*) "\n", 1);
 
-  daFree(daiBytes);
+  free(pucIn);
+  free(pucOut);
 }
 
 //*** decoder
@@ -353,117 +1053,792 @@ void ascii852bin(FILE* hFile) {
 
 
 //******************************************************************************
-//*** encoder
+//*** index
 
 /*******************************************************************************
- * Name:  readASCII852Array
- * Purpose: Reads a file into a dynamic array.
+ * Name:  initIndex
+ * Purpose: Sets key of index from file's size, mtime and a FNV-1a hash of its
+ *          first and last bytes. Returns 0, if file is not a regular one.
  *******************************************************************************/
-int readFile2array(t_array(int)* pdaiBytes, FILE* hFile) {
-  int b = 0;
-
-  // Read bytes until eof.
-  while (fread(&b, sizeof(char), 1, hFile))
-    daAdd(int, (*pdaiBytes), b);
+int initIndex(t_index* ptIdx, FILE* hFile) {
+  struct stat tStat  = {0};
+  uchar*      pucBuf = NULL;
+  off_t       aoPos[2];
+  ssize_t     sRead  = 0;
+
+  daInit(t_idxblk, ptIdx->tBlocks);
+  daInit(size_t,   ptIdx->tChars);
+
+  if (fstat(fileno(hFile), &tStat) || ! S_ISREG(tStat.st_mode)) return 0;
+
+  ptIdx->oSize   = tStat.st_size;
+  ptIdx->llMtime = (ll) tStat.st_mtim.tv_sec * 1000000000ll + tStat.st_mtim.tv_nsec;
+  ptIdx->u64Hash = FNV_OFFSET;
+
+  // Hash first and last bytes, they overlap in small files.
+  pucBuf   = (uchar*) malloc(IDX_HASHED);
+  aoPos[0] = 0;
+  aoPos[1] = (tStat.st_size > IDX_HASHED) ? tStat.st_size - IDX_HASHED : 0;
+  for (int i = 0; i < 2; ++i) {
+    sRead = pread(fileno(hFile), pucBuf, IDX_HASHED, aoPos[i]);
+    for (ssize_t j = 0; j < sRead; ++j) {
+      ptIdx->u64Hash ^= pucBuf[j];
+      ptIdx->u64Hash *= FNV_PRIME;
+    }
+  }
+  free(pucBuf);
 
   return 1;
 }
 
 /*******************************************************************************
- * Name:  padArrayTo4
- * Purpose: Pads array with 0 so its length is a multiple of 4.
+ * Name:  freeIndex
+ * Purpose: Frees index's blocks and checkpoints.
+ *******************************************************************************/
+void freeIndex(t_index* ptIdx) {
+  daFree(ptIdx->tBlocks);
+  daFree(ptIdx->tChars);
+}
+
+/*******************************************************************************
+ * Name:  readIndex
+ * Purpose: Reads index file, if it belongs to the key of the index.
+ *          Returns 0, if index file is missing, broken or stale.
  *******************************************************************************/
-int padArrayTo4(t_array(int)* pdaiBytes) {
-  int iPad = 4 - (pdaiBytes->sCount) % 4;
+int readIndex(t_index* ptIdx, const char* pcName) {
+  FILE*    hIdx     = fopen(pcName, "r");
+  char     acMagic[8];
+  int      iVersion = 0;
+  ll       llStep   = 0;
+  ll       llSize   = 0;
+  ll       llMtime  = 0;
+  uint64_t u64Hash  = 0;
+  ll       llBeg    = 0;
+  ll       llEob    = 0;
+  size_t   sCount   = 0;
+  size_t   sChars   = 0;
+  t_idxblk tBlk     = {0};
+  int      iOk      = 0;
+
+  if (! hIdx) return 0;
+
+  if (fscanf(hIdx, "%7s %d %lld %lld %lld %" SCNx64, acMagic, &iVersion,
+             &llStep, &llSize, &llMtime, &u64Hash) != 6 ||
+      strcmp(acMagic, IDX_MAGIC) || iVersion != IDX_VERSION ||
+      llStep != IDX_STEP || llSize != ptIdx->oSize ||
+      llMtime != ptIdx->llMtime || u64Hash != ptIdx->u64Hash)
+    goto done;
+
+  // One line per block: offsets of '<~' and '~', checkpoints.
+  while (fscanf(hIdx, "%lld %lld %zu", &llBeg, &llEob, &sCount) == 3) {
+    tBlk.oBeg   = llBeg;
+    tBlk.oEob   = llEob;
+    tBlk.sFirst = ptIdx->tChars.sCount;
+    tBlk.sCount = sCount;
+    for (size_t i = 0; i < sCount; ++i) {
+      if (fscanf(hIdx, "%zu", &sChars) != 1) goto done;
+      daAdd(size_t, ptIdx->tChars, sChars);
+    }
+    daAdd(t_idxblk, ptIdx->tBlocks, tBlk);
+  }
+  iOk = feof(hIdx);
+
+done:
+  fclose(hIdx);
+  if (! iOk) {
+    ptIdx->tBlocks.sCount = 0;
+    ptIdx->tChars.sCount  = 0;
+  }
+  return iOk;
+}
+
+/*******************************************************************************
+ * Name:  buildIndex
+ * Purpose: Scans mapped file once for all blocks and counts the valid chars
+ *          of each payload at every IDX_STEP bytes.
+ *******************************************************************************/
+void buildIndex(t_index* ptIdx, const uchar* pucMap) {
+  t_idxblk     tBlk   = {0};
+  const uchar* pucBeg = pucMap;
+  const uchar* pucEnd = pucMap + ptIdx->oSize;
+  const uchar* pucEob = NULL;
+  size_t       sChars = 0;
+  size_t       sLen   = 0;
+
+  while (pucBeg < pucEnd) {
+    pucBeg = a85FindPayload(pucBeg, pucEnd);
+    if (! pucBeg || ! (pucEob = memchr(pucBeg, A85_C_EOB, pucEnd - pucBeg)))
+      break;
+
+    tBlk.oBeg   = pucBeg - 2 - pucMap;
+    tBlk.oEob   = pucEob - pucMap;
+    tBlk.sFirst = ptIdx->tChars.sCount;
+    sChars      = 0;
+    for (const uchar* p = pucBeg; p < pucEob; p += sLen) {
+      sLen    = (pucEob - p < IDX_STEP) ? (size_t) (pucEob - p) : IDX_STEP;
+      sChars += a85Count(p, sLen);
+      daAdd(size_t, ptIdx->tChars, sChars);
+    }
+    tBlk.sCount = ptIdx->tChars.sCount - tBlk.sFirst;
+    daAdd(t_idxblk, ptIdx->tBlocks, tBlk);
+
+    pucBeg = pucEob + 1;
+  }
+}
 
-  if (iPad == 4) return 0;
+/*******************************************************************************
+ * Name:  writeIndex
+ * Purpose: Writes index file via a temporary one, so readers never see half
+ *          of it. A read-only directory just leaves the file without index.
+ *******************************************************************************/
+void writeIndex(const t_index* ptIdx, const char* pcName) {
+  cstr  csTmp = csNew("");
+  FILE* hIdx  = NULL;
+
+  csSetf(&csTmp, "%s.%d", pcName, (int) getpid());
+  if (! (hIdx = fopen(csTmp.cStr, "w"))) goto done;
+
+  fprintf(hIdx, "%s %d %lld %lld %lld %016" PRIx64 "\n", IDX_MAGIC, IDX_VERSION,
+          (ll) IDX_STEP, (ll) ptIdx->oSize, ptIdx->llMtime, ptIdx->u64Hash);
+  for (size_t b = 0; b < ptIdx->tBlocks.sCount; ++b) {
+    t_idxblk* ptBlk = &ptIdx->tBlocks.pVal[b];
+    fprintf(hIdx, "%lld %lld %zu", (ll) ptBlk->oBeg, (ll) ptBlk->oEob, ptBlk->sCount);
+    for (size_t i = 0; i < ptBlk->sCount; ++i)
+      fprintf(hIdx, " %zu", ptIdx->tChars.pVal[ptBlk->sFirst + i]);
+    fprintf(hIdx, "\n");
+  }
 
-  // Padding is like follows:
-  // Chars:   0 1 2 3 4 5 6 7 8
-  // Padding: 0 3 2 1 0 3 2 1 0
+  if (fclose(hIdx) || rename(csTmp.cStr, pcName)) remove(csTmp.cStr);
 
-  for (int i = 0; i < iPad; ++i)
-    daAdd(int, (*pdaiBytes), 0);
+done:
+  csFree(&csTmp);
+}
 
-  return iPad;
+/*******************************************************************************
+ * Name:  getIndex
+ * Purpose: Reads file's sidecar index, or builds and writes it, if missing or
+ *          stale. Returns 0, if no index is wanted or possible.
+ *******************************************************************************/
+int getIndex(t_index* ptIdx, const char* pcName, FILE* hFile) {
+  cstr         csIdx  = csNew("");
+  const uchar* pucMap = NULL;
+  int          iOk    = 0;
+
+  if (! g_tOpts.iIndex || ! pcName) return 0;
+  if (! initIndex(ptIdx, hFile)) goto done;
+
+  csSetf(&csIdx, "%s%s", pcName, IDX_SUFFIX);
+  if ((iOk = readIndex(ptIdx, csIdx.cStr))) goto done;
+
+  if (ptIdx->oSize > 0) {
+    pucMap = (const uchar*) mmap(NULL, ptIdx->oSize, PROT_READ, MAP_PRIVATE, fileno(hFile), 0);
+    if (pucMap == MAP_FAILED) goto done;
+    buildIndex(ptIdx, pucMap);
+    munmap((void*) pucMap, ptIdx->oSize);
+  }
+  writeIndex(ptIdx, csIdx.cStr);
+  iOk = 1;
+
+done:
+  if (! iOk) freeIndex(ptIdx);
+  csFree(&csIdx);
+  return iOk;
 }
 
+//*** index
+//******************************************************************************
+
+
+//******************************************************************************
+//*** parallel decoder
+
 /*******************************************************************************
- * Name:  get5BlockFrom4Int
- * Purpose: Converts a 4 byte integer into 5 bytes.
+ * Name:  countChunk
+ * Purpose: First pass, counts valid chars of a chunk with expanded 'z'.
  *******************************************************************************/
-void get5BlockFrom4Int(int* n, t_array(int)* pdaiBytes, off_t* poOff) {
-  t_i32c ui32c = {0};
+void countChunk(t_pool* ptPool, size_t c) {
+  t_chunk* ptChunk = &ptPool->ptChunks[c];
+  ptChunk->sNext = a85Count(ptChunk->pucBeg, ptChunk->pucEnd - ptChunk->pucBeg);
+}
 
-  // Read 4 bytes from array.
-  for (int i = 0; i < 4; ++i)
-    ui32c.aChars[3 - i] = pdaiBytes->pVal[*poOff + i];
+/*******************************************************************************
+ * Name:  decodeChunk
+ * Purpose: Second pass, decodes all groups starting within the chunk.
+ *          The last group may reach into the next chunks.
+ *******************************************************************************/
+void decodeChunk(t_pool* ptPool, size_t c) {
+  t_chunk*     ptChunk = &ptPool->ptChunks[c];
+  t_a85dec     tDec    = {0};
+  uchar*       pucOut  = NULL;
+  size_t       sFrom   = ptChunk->sFirst;
+  size_t       sLen    = 0;
+
+  // Groups start every 5 chars.
+  if (sFrom % 5) sFrom += 5 - sFrom % 5;
+
+  // No group starts here.
+  if (sFrom >= ptChunk->sNext) return;
+
+  a85DecInit(&tDec);
+  a85DecSeek(&tDec, 0, 0, sFrom - ptChunk->sFirst);
+  pucOut = (uchar*) malloc(a85DecBound(A85_BUFSIZE));
+
+  for (const uchar* p = ptChunk->pucBeg; p < ptChunk->pucEnd; p += sLen) {
+    sLen = (ptChunk->pucEnd - p < A85_BUFSIZE) ? (size_t) (ptChunk->pucEnd - p) : A85_BUFSIZE;
+    writeSink(&ptChunk->tOut, pucOut, a85DecFeed(&tDec, p, sLen, pucOut));
+  }
 
-  // Get the 5 chars out of the integer.
-  n[0] = ((ui32c.u32Int / (85 * 85 * 85 * 85)) % 85) + 33;
-  n[1] = ((ui32c.u32Int / (85 * 85 * 85     )) % 85) + 33;
-  n[2] = ((ui32c.u32Int / (85 * 85          )) % 85) + 33;
-  n[3] = ((ui32c.u32Int / (85               )) % 85) + 33;
-  n[4] = ((ui32c.u32Int                      ) % 85) + 33;
+  // Last group may reach into the next chunks.
+  sLen = a85DecFinishChunk(&tDec, ptChunk->pucEnd, ptPool->pucPayEnd - ptChunk->pucEnd, pucOut);
+  writeSink(&ptChunk->tOut, pucOut, sLen);
 
-  *poOff += 4;
+  free(pucOut);
 }
 
 /*******************************************************************************
- * Name:  .
- * Purpose: .
+ * Name:  poolWorker
+ * Purpose: Thread, takes chunks in order until all are done. Decoding waits
+ *          if too many decoded chunks are not written yet.
  *******************************************************************************/
-void print5chars(int* b, int iMax) {
-  for (int i = 0; i < iMax; ++i)
-    printf("%c", b[i]);
+void* poolWorker(void* pvPool) {
+  t_pool* ptPool = (t_pool*) pvPool;
+  size_t  c      = 0;
+
+  while (1) {
+    pthread_mutex_lock(&ptPool->tMutex);
+    while (ptPool->iPass == PAR_DECODE && ptPool->sNextJob < ptPool->sChunks &&
+           ptPool->sNextJob >= ptPool->sWritten + ptPool->sWindow)
+      pthread_cond_wait(&ptPool->tCond, &ptPool->tMutex);
+    if (ptPool->sNextJob >= ptPool->sChunks) {
+      pthread_mutex_unlock(&ptPool->tMutex);
+      break;
+    }
+    c = ptPool->sNextJob++;
+    pthread_mutex_unlock(&ptPool->tMutex);
+
+    if (ptPool->iPass == PAR_COUNT)  countChunk(ptPool, c);
+    if (ptPool->iPass == PAR_DECODE) decodeChunk(ptPool, c);
+
+    pthread_mutex_lock(&ptPool->tMutex);
+    ptPool->ptChunks[c].iDone = 1;
+    pthread_cond_broadcast(&ptPool->tCond);
+    pthread_mutex_unlock(&ptPool->tMutex);
+  }
+
+  return NULL;
 }
 
 /*******************************************************************************
- * Name:  .
- * Purpose: .
+ * Name:  runPool
+ * Purpose: Runs one pass over all chunks with all threads. While decoding,
+ *          the calling thread prints the chunks in order.
  *******************************************************************************/
-void bin2ascii85(FILE* hFile) {
-  int          n[5]     = {0};
-  t_array(int) daiBytes = {0};
-  off_t        oOff     = g_tOpts.oOffset;
-  int          iPad     = 0;
-  int          iN       = 5;
+void runPool(t_pool* ptPool, int iPass, int iThreads) {
+  pthread_t* ptThreads = (pthread_t*) malloc(iThreads * sizeof(pthread_t));
 
-  daInit(int, daiBytes);
+  ptPool->iPass    = iPass;
+  ptPool->sNextJob = 0;
+  ptPool->sWritten = 0;
+  for (size_t c = 0; c < ptPool->sChunks; ++c) ptPool->ptChunks[c].iDone = 0;
 
-  // Read the file into a byte array
-  if (! readFile2array(&daiBytes, hFile))
-    dispatchError(ERR_FILE, "Error reading file");
+  for (int i = 0; i < iThreads; ++i)
+    if (pthread_create(&ptThreads[i], NULL, poolWorker, ptPool))
+      dispatchError(ERR_ELSE, "Can't create thread");
+
+  if (iPass == PAR_DECODE) {
+    for (size_t c = 0; c < ptPool->sChunks; ++c) {
+      t_chunk* ptChunk = &ptPool->ptChunks[c];
 
-  // Pad to mod 4 and save pad count
-  iPad = padArrayTo4(&daiBytes);
+      pthread_mutex_lock(&ptPool->tMutex);
+      while (! ptChunk->iDone) pthread_cond_wait(&ptPool->tCond, &ptPool->tMutex);
+      pthread_mutex_unlock(&ptPool->tMutex);
 
-  printf("<~");
-  while(1) {
-    get5BlockFrom4Int(n, &daiBytes, &oOff);
-    if (oOff == daiBytes.sCount) iN = 5 - iPad;
-    print5chars(n, iN);
-    if (oOff >= daiBytes.sCount) break;
+      writeOut(stdout, ptChunk->tOut.pucBuf, ptChunk->tOut.sLen);
+      freeSink(&ptChunk->tOut);
+
+      pthread_mutex_lock(&ptPool->tMutex);
+      ptPool->sWritten = c + 1;
+      pthread_cond_broadcast(&ptPool->tCond);
+      pthread_mutex_unlock(&ptPool->tMutex);
+    }
   }
-  printf("~>");
+
+  for (int i = 0; i < iThreads; ++i) pthread_join(ptThreads[i], NULL);
+
+  free(ptThreads);
+}
+
+/*******************************************************************************
+ * Name:  ascii852binParallel
+ * Purpose: Decodes a mapped file with several threads. A first pass counts
+ *          the valid chars per chunk, so all chunks can be cut on exact group
+ *          boundaries and decoded independently. An index has these counts
+ *          already. Returns 0, if the file can't be mapped or all blocks are
+ *          wanted.
+ *******************************************************************************/
+int ascii852binParallel(FILE* hFile, const char* pcName) {
+  t_pool       tPool   = {0};
+  t_index      tIdx    = {0};
+  t_idxblk*    ptBlk   = NULL;
+  int          iIndex  = 0;
+  int          iBlock  = 0;
+  ll           llBlk   = -1;
+  struct stat  tStat   = {0};
+  const uchar* pucMap  = NULL;
+  const uchar* pucBeg  = NULL;
+  const uchar* pucEnd  = NULL;
+  const uchar* pucEob  = NULL;
+  size_t       sChars  = 0;
+
+  if (g_tOpts.iList || g_tOpts.iBlock == A85_BLOCK_ALL || g_tOpts.oRangeLen >= 0) return 0;
+  if (fstat(fileno(hFile), &tStat) || ! S_ISREG(tStat.st_mode) || tStat.st_size == 0)
+    return 0;
+  pucMap = (const uchar*) mmap(NULL, tStat.st_size, PROT_READ, MAP_PRIVATE, fileno(hFile), 0);
+  if (pucMap == MAP_FAILED) return 0;
+
+  // Take payload of wanted block from index, or find it between '<~' and '~'.
+  pucBeg = pucMap + g_tOpts.oOffset;
+  pucEnd = pucMap + tStat.st_size;
+  if ((iIndex = getIndex(&tIdx, pcName, hFile)) &&
+      (llBlk = findIndexBlock(&tIdx, g_tOpts.iBlock)) >= 0) {
+    ptBlk  = &tIdx.tBlocks.pVal[llBlk];
+    pucBeg = pucMap + ptBlk->oBeg + 2;
+    pucEob = pucMap + ptBlk->oEob;
+  }
+  while (! ptBlk) {
+    pucBeg = a85FindPayload(pucBeg, pucEnd);
+    if (! pucBeg && iBlock > 0)
+      dispatchError(ERR_FILE, "Block not found");
+    if (! pucBeg || ! (pucEob = memchr(pucBeg, A85_C_EOB, pucEnd - pucBeg)))
+      dispatchError(ERR_FILE, "Error reading file");
+    if (iBlock++ == g_tOpts.iBlock) break;
+    pucBeg = pucEob + 1;
+  }
+  pucEnd = pucEob;
+
+  // Cut payload into chunks.
+  tPool.sChunks   = (pucEnd - pucBeg + PAR_CHUNK - 1) / PAR_CHUNK;
+  tPool.ptChunks  = (t_chunk*) calloc(tPool.sChunks + 1, sizeof(t_chunk));
+  tPool.pucPayEnd = pucEnd;
+  tPool.sWindow   = 2 * g_tOpts.iThreads;
+  pthread_mutex_init(&tPool.tMutex, NULL);
+  pthread_cond_init(&tPool.tCond, NULL);
+
+  for (size_t c = 0; c < tPool.sChunks; ++c) {
+    tPool.ptChunks[c].pucBeg = pucBeg + c * PAR_CHUNK;
+    tPool.ptChunks[c].pucEnd = (c + 1 < tPool.sChunks) ? pucBeg + (c + 1) * PAR_CHUNK : pucEnd;
+    initSink(&tPool.ptChunks[c].tOut, NULL);
+  }
+
+  // Chars per chunk to char offsets of chunks, the index has them counted.
+  if (ptBlk) {
+    for (size_t c = 0; c < tPool.sChunks; ++c) {
+      tPool.ptChunks[c].sFirst = sChars;
+      sChars = tIdx.tChars.pVal[ptBlk->sFirst + c];
+      tPool.ptChunks[c].sNext  = sChars;
+    }
+  }
+  else {
+    runPool(&tPool, PAR_COUNT, g_tOpts.iThreads);
+    for (size_t c = 0; c < tPool.sChunks; ++c) {
+      tPool.ptChunks[c].sFirst = sChars;
+      sChars += tPool.ptChunks[c].sNext;
+      tPool.ptChunks[c].sNext  = sChars;
+    }
+  }
+
+  runPool(&tPool, PAR_DECODE, g_tOpts.iThreads);
 
   // Print an end of line, if wanted.
   if(g_tOpts.iPrtEol) printf("\n");
 
-  daFree(daiBytes);
+  pthread_mutex_destroy(&tPool.tMutex);
+  pthread_cond_destroy(&tPool.tCond);
+  free(tPool.ptChunks);
+  if (iIndex) freeIndex(&tIdx);
+  munmap((void*) pucMap, tStat.st_size);
+
+  return 1;
+}
+
+//*** parallel decoder
+//******************************************************************************
+
+
+//******************************************************************************
+//*** encoder
+
+/*******************************************************************************
+ * Name:  bin2ascii85
+ * Purpose: Converts a byte stream to an ascii85 data stream chunk by chunk.
+ *          The encoder keeps up to 3 bytes between chunks and pads only the
+ *          last word at eof, so memory usage is constant.
+ *******************************************************************************/
+void bin2ascii85(FILE* hFile, t_sink* ptOut) {
+  t_a85enc tEnc   = {0};
+  uchar*   pucIn  = (uchar*) malloc(A85_BUFSIZE);
+  uchar*   pucOut = (uchar*) malloc(a85EncBound(A85_BUFSIZE));
+  size_t   sRead  = 0;
+
+  a85EncInit(&tEnc);
+  tEnc.iWrap   = g_tOpts.iWrap;
+  tEnc.iNoZero = g_tOpts.iNoZero;
+
+  while ((sRead = fread(pucIn, 1, A85_BUFSIZE, hFile)) > 0)
+    writeSink(ptOut, pucOut, a85EncFeed(&tEnc, pucIn, sRead, pucOut));
+  if (ferror(hFile))
+    dispatchError(ERR_FILE, "Error reading file");
+
+  writeSink(ptOut, pucOut, a85EncFinish(&tEnc, pucOut));
+
+  // Print an end of line, if wanted.
+  if(g_tOpts.iPrtEol) writeSink(ptOut, (const uchar*) "\n", 1);
+
+  free(pucIn);
+  free(pucOut);
 }
 
 //*** encoder
 //******************************************************************************
 
 
+//******************************************************************************
+//*** files
+
+/*******************************************************************************
+ * Name:  openInput
+ * Purpose: Opens file and seeks to given offset.
+ *******************************************************************************/
+FILE* openInput(const char* pcName) {
+  FILE* hFile = openFile(pcName, "rb");
+  off_t oSize = getFileSize(hFile);
+
+  if (g_tOpts.oOffset > oSize)
+    dispatchError(ERR_FILE, "Offset greater than file size");
+  fseeko(hFile, g_tOpts.oOffset, SEEK_SET);
+
+  return hFile;
+}
+
+/*******************************************************************************
+ * Name:  skipInput
+ * Purpose: Skips bytes up to given offset of a pipe, where seeking fails.
+ *******************************************************************************/
+void skipInput(FILE* hFile, off_t oOffset) {
+  uchar  aucBuf[A85_BUFSIZE];
+  size_t sRead = 0;
+
+  while (oOffset > 0) {
+    sRead = (oOffset < A85_BUFSIZE) ? (size_t) oOffset : A85_BUFSIZE;
+    if ((sRead = fread(aucBuf, 1, sRead, hFile)) == 0) break;
+    oOffset -= sRead;
+  }
+}
+
+/*******************************************************************************
+ * Name:  convertFile
+ * Purpose: Decodes or encodes one file into the sink. Decoding uses the file's
+ *          index, if wanted and the file has a name.
+ *******************************************************************************/
+void convertFile(FILE* hFile, const char* pcName, t_sink* ptOut) {
+  t_index tIdx   = {0};
+  int     iIndex = 0;
+
+  if (g_tOpts.iEncode) {
+    bin2ascii85(hFile, ptOut);
+    return;
+  }
+
+  iIndex = getIndex(&tIdx, pcName, hFile);
+  ascii852bin(hFile, iIndex ? &tIdx : NULL, ptOut);
+  if (iIndex) freeIndex(&tIdx);
+}
+
+//*** files
+//******************************************************************************
+
+
+//******************************************************************************
+//*** parallel files
+
+/*******************************************************************************
+ * Name:  flushJobSink
+ * Purpose: Prints sink's buffer, if its file is next in argument order. Other
+ *          files wait here, while too many bytes are buffered.
+ *******************************************************************************/
+void flushJobSink(t_sink* ptSink) {
+  t_jobs* ptJobs = ptSink->ptJobs;
+
+  pthread_mutex_lock(&ptJobs->tMutex);
+  ptJobs->sBuffered += ptSink->sLen - ptSink->sCounted;
+  ptSink->sCounted   = ptSink->sLen;
+
+  while (ptSink->sIndex != ptJobs->sHead && ptJobs->sBuffered > ptJobs->sMaxBuf)
+    pthread_cond_wait(&ptJobs->tCond, &ptJobs->tMutex);
+
+  if (ptSink->sIndex == ptJobs->sHead) {
+    writeOut(stdout, ptSink->pucBuf, ptSink->sLen);
+    ptJobs->sBuffered -= ptSink->sLen;
+    ptSink->sLen       = 0;
+    ptSink->sCounted   = 0;
+    pthread_cond_broadcast(&ptJobs->tCond);
+  }
+  pthread_mutex_unlock(&ptJobs->tMutex);
+}
+
+/*******************************************************************************
+ * Name:  finishJob
+ * Purpose: Marks file as done and prints all done files in argument order.
+ *******************************************************************************/
+void finishJob(t_jobs* ptJobs, size_t sIndex) {
+  pthread_mutex_lock(&ptJobs->tMutex);
+  ptJobs->sBuffered            += ptJobs->ptOut[sIndex].sLen - ptJobs->ptOut[sIndex].sCounted;
+  ptJobs->ptOut[sIndex].sCounted = ptJobs->ptOut[sIndex].sLen;
+  ptJobs->piDone[sIndex]         = 1;
+
+  while (ptJobs->sHead < ptJobs->sFiles && ptJobs->piDone[ptJobs->sHead]) {
+    t_sink* ptOut = &ptJobs->ptOut[ptJobs->sHead++];
+    writeOut(stdout, ptOut->pucBuf, ptOut->sLen);
+    ptJobs->sBuffered -= ptOut->sLen;
+    freeSink(ptOut);
+  }
+  pthread_cond_broadcast(&ptJobs->tCond);
+  pthread_mutex_unlock(&ptJobs->tMutex);
+}
+
+/*******************************************************************************
+ * Name:  failJob
+ * Purpose: Waits, until the failing file is next in argument order and prints
+ *          what it converted so far. Keeps the lock, so nothing else is
+ *          printed before the error ends the program.
+ *******************************************************************************/
+void failJob(t_sink* ptSink) {
+  t_jobs* ptJobs = ptSink->ptJobs;
+
+  // Failed while printing, so this thread holds the lock and is in order.
+  if (pthread_mutex_lock(&ptJobs->tMutex) != 0) return;
+
+  while (ptSink->sIndex != ptJobs->sHead)
+    pthread_cond_wait(&ptJobs->tCond, &ptJobs->tMutex);
+  writeOut(stdout, ptSink->pucBuf, ptSink->sLen);
+}
+
+/*******************************************************************************
+ * Name:  jobWorker
+ * Purpose: Thread, converts one file after the other into its own sink. Files
+ *          behind the head aren't started, while too many bytes are buffered.
+ *******************************************************************************/
+void* jobWorker(void* pvJobs) {
+  t_jobs* ptJobs = (t_jobs*) pvJobs;
+  FILE*   hFile  = NULL;
+  size_t  i      = 0;
+
+  while (1) {
+    pthread_mutex_lock(&ptJobs->tMutex);
+    while (ptJobs->sNextJob != ptJobs->sHead && ptJobs->sBuffered > ptJobs->sMaxBuf)
+      pthread_cond_wait(&ptJobs->tCond, &ptJobs->tMutex);
+    i = ptJobs->sNextJob++;
+    pthread_mutex_unlock(&ptJobs->tMutex);
+    if (i >= ptJobs->sFiles) break;
+
+    g_ptJobSink = &ptJobs->ptOut[i];
+    hFile       = openInput(g_tArgs.pVal[i].cStr);
+    convertFile(hFile, g_tArgs.pVal[i].cStr, &ptJobs->ptOut[i]);
+    fclose(hFile);
+    g_ptJobSink = NULL;
+
+    finishJob(ptJobs, i);
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  convertFilesParallel
+ * Purpose: Converts all files with a pool of threads. Output is buffered per
+ *          file and printed in argument order.
+ *******************************************************************************/
+void convertFilesParallel(void) {
+  t_jobs              tJobs     = {0};
+  pthread_mutexattr_t tAttr;
+  pthread_t*          ptThreads = (pthread_t*) malloc(g_tOpts.iThreads * sizeof(pthread_t));
+
+  tJobs.sFiles  = g_tArgs.sCount;
+  tJobs.sMaxBuf = g_tOpts.oMaxBuf;
+  tJobs.piDone  = (int*) calloc(tJobs.sFiles, sizeof(int));
+  tJobs.ptOut   = (t_sink*) calloc(tJobs.sFiles, sizeof(t_sink));
+  // Locking twice fails instead of blocking, see 'failJob()'.
+  pthread_mutexattr_init(&tAttr);
+  pthread_mutexattr_settype(&tAttr, PTHREAD_MUTEX_ERRORCHECK);
+  pthread_mutex_init(&tJobs.tMutex, &tAttr);
+  pthread_mutexattr_destroy(&tAttr);
+  pthread_cond_init(&tJobs.tCond, NULL);
+
+  for (size_t i = 0; i < tJobs.sFiles; ++i) {
+    initSink(&tJobs.ptOut[i], NULL);
+    tJobs.ptOut[i].ptJobs = &tJobs;
+    tJobs.ptOut[i].sIndex = i;
+  }
+
+  for (int i = 0; i < g_tOpts.iThreads; ++i)
+    if (pthread_create(&ptThreads[i], NULL, jobWorker, &tJobs))
+      dispatchError(ERR_ELSE, "Can't create thread");
+
+  for (int i = 0; i < g_tOpts.iThreads; ++i) pthread_join(ptThreads[i], NULL);
+
+  pthread_mutex_destroy(&tJobs.tMutex);
+  pthread_cond_destroy(&tJobs.tCond);
+  free(tJobs.piDone);
+  free(tJobs.ptOut);
+  free(ptThreads);
+}
+
+//*** parallel files
+//******************************************************************************
+
+
+//******************************************************************************
+//*** benchmark
+
+/*******************************************************************************
+ * Name:  getSeconds
+ * Purpose: Returns monotonic time in seconds.
+ *******************************************************************************/
+double getSeconds(void) {
+  struct timespec tTs = {0};
+  clock_gettime(CLOCK_MONOTONIC, &tTs);
+  return tTs.tv_sec + tTs.tv_nsec / 1e9;
+}
+
+/*******************************************************************************
+ * Name:  createBenchData
+ * Purpose: Creates random ascii85 text with 60 chars per line and '~>' at end.
+ *******************************************************************************/
+uchar* createBenchData(size_t* psLen) {
+  uchar*   pucData = (uchar*) malloc(BENCH_SIZE + 8);
+  size_t   sPos    = 0;
+  int      iCol    = 0;
+  uint32_t u32Rnd  = 0x12345678;
+
+  if (! pucData) dispatchError(ERR_ELSE, "Out of memory");
+
+  while (sPos + 7 < BENCH_SIZE) {
+    // Simple xorshift, good enough for test data.
+    u32Rnd ^= u32Rnd << 13;
+    u32Rnd ^= u32Rnd >> 17;
+    u32Rnd ^= u32Rnd <<  5;
+
+    for (int i = 4; i >= 0; --i) {
+      uint32_t u32Div = 1;
+      for (int j = 0; j < i; ++j) u32Div *= 85;
+      pucData[sPos++] = (uchar) ((u32Rnd / u32Div) % 85 + 33);
+      if (++iCol == 60) {
+        pucData[sPos++] = '\n';
+        iCol = 0;
+      }
+    }
+  }
+  pucData[sPos++] = '~';
+  pucData[sPos++] = '>';
+
+  *psLen = sPos;
+  return pucData;
+}
+
+/*******************************************************************************
+ * Name:  benchDecode
+ * Purpose: Returns seconds needed to decode the data with current kernel.
+ *******************************************************************************/
+double benchDecode(const uchar* pucData, size_t sLen) {
+  t_a85dec tDec   = {0};
+  uchar*   pucOut = (uchar*) malloc(a85DecBound(A85_BUFSIZE));
+  double   dStart = getSeconds();
+
+  a85DecInit(&tDec);
+  a85DecSeek(&tDec, 0, 0, 0);
+  for (size_t sOff = 0; sOff < sLen; sOff += A85_BUFSIZE)
+    a85DecFeed(&tDec, pucData + sOff, (sLen - sOff < A85_BUFSIZE) ? sLen - sOff : A85_BUFSIZE, pucOut);
+
+  free(pucOut);
+  return getSeconds() - dStart;
+}
+
+/*******************************************************************************
+ * Name:  benchEncode
+ * Purpose: Returns seconds needed to encode the data with current kernel.
+ *******************************************************************************/
+double benchEncode(const uchar* pucData, size_t sLen) {
+  t_a85enc tEnc   = {0};
+  uchar*   pucOut = (uchar*) malloc(a85EncBound(A85_BUFSIZE));
+  double   dStart = getSeconds();
+
+  a85EncInit(&tEnc);
+  for (size_t sOff = 0; sOff < sLen; sOff += A85_BUFSIZE)
+    a85EncFeed(&tEnc, pucData + sOff, (sLen - sOff < A85_BUFSIZE) ? sLen - sOff : A85_BUFSIZE, pucOut);
+  a85EncFinish(&tEnc, pucOut);
+
+  free(pucOut);
+  return getSeconds() - dStart;
+}
+
+/*******************************************************************************
+ * Name:  benchmark
+ * Purpose: Prints throughput of all kernels supported by this host.
+ *******************************************************************************/
+void benchmark(void) {
+  size_t      sLen     = 0;
+  uchar*      pucData  = createBenchData(&sLen);
+  const char* pcDec    = NULL;
+  const char* pcEnc    = NULL;
+  double      dBestDec = 0.0;
+  double      dBestEnc = 0.0;
+
+  printf("kernel   decode MB/s  encode MB/s\n");
+
+  for (int i = 0; i < a85KernelCount(); ++i) {
+    double dDec = 0.0;
+    double dEnc = 0.0;
+
+    if (! a85KernelSupported(i)) continue;
+    a85SelectKernel(a85KernelName(i));
+
+    // Best of three runs.
+    for (int r = 0; r < 3; ++r) {
+      double dTime = benchDecode(pucData, sLen);
+      if (r == 0 || dTime < dDec) dDec = dTime;
+      dTime = benchEncode(pucData, sLen);
+      if (r == 0 || dTime < dEnc) dEnc = dTime;
+    }
+    printf("%-8s %11.1f  %11.1f\n", a85KernelInUse(), sLen / dDec / 1e6, sLen / dEnc / 1e6);
+
+    // Remember the fastest kernels.
+    if (! pcDec || dDec < dBestDec) {
+      pcDec    = a85KernelName(i);
+      dBestDec = dDec;
+    }
+    if (! pcEnc || dEnc < dBestEnc) {
+      pcEnc    = a85KernelName(i);
+      dBestEnc = dEnc;
+    }
+  }
+
+  if (g_tOpts.iCalibrate) writeKernelConfig(pcDec, pcEnc);
+
+  free(pucData);
+}
+
+//*** benchmark
+//******************************************************************************
+
+
 //******************************************************************************
 //* main
 
 int main(int argc, char *argv[]) {
-  FILE* hFile  = NULL;
-  off_t oSize  = 0;
-  int   iStdin = 0;
+  FILE*       hFile  = NULL;
+  const char* pcName = NULL;
+  t_sink      tOut   = {0};
+  int         iStdin = 0;
 
   // Save program's name.
   g_csMename = csNew("");
@@ -472,31 +1847,52 @@ int main(int argc, char *argv[]) {
   // Get options and dispatch errors, if any.
   getOptions(argc, argv);
 
+  // Use the fastest decoder kernel for this host, if none was given.
+  selectKernel(g_tOpts.csKernel.cStr);
+
+  // Only measure speed of kernels.
+  if (g_tOpts.iBench) {
+    benchmark();
+    return ERR_NOERR;
+  }
+
+  // Hash output instead of printing it, if wanted.
+  initDigest();
+
   // If to use stdin instead of files, say so.
   iStdin = g_tOpts.iReadStdin;
+  initSink(&tOut, stdout);
 
   // Get all data from all files, or stdin.
   for (int i = 0; i < g_tArgs.sCount || iStdin; ++i) {
+    // Convert many files at once.
+    if (g_tOpts.iThreads > 1 && g_tArgs.sCount > 1) {
+      convertFilesParallel();
+      break;
+    }
     if (iStdin) {
       hFile  = stdin;
+      pcName = NULL;
       iStdin = 0;
+      skipInput(hFile, g_tOpts.oOffset);
     }
     else {
-      hFile = openFile(g_tArgs.pVal[i].cStr, "rb");
-      oSize = getFileSize(hFile);
-      if (g_tOpts.oOffset > oSize)
-        dispatchError(ERR_FILE, "Offset greater than file size");
-      fseeko(hFile, g_tOpts.oOffset, SEEK_SET);
+      pcName = g_tArgs.pVal[i].cStr;
+      hFile  = openInput(pcName);
     }
 //-- file ----------------------------------------------------------------------
-    if (! g_tOpts.iEncode) ascii852bin(hFile);
-    if (  g_tOpts.iEncode) bin2ascii85(hFile);
+    if (g_tOpts.iEncode || g_tOpts.iThreads == 1 || ! ascii852binParallel(hFile, pcName))
+      convertFile(hFile, pcName, &tOut);
 //-- file ----------------------------------------------------------------------
     fclose(hFile);
   }
 
+  if (g_tOpts.iDigest != DIG_NONE) finishDigest();
+
   // Free all used memory, prior end of program.
   daFreeEx(g_tArgs, cStr);
+  csFree(&g_tOpts.csKernel);
+  csFree(&g_tOpts.csVerify);
 
   return ERR_NOERR;
 }
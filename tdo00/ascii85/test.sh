@@ -0,0 +1,87 @@
+#!/bin/bash
+#*******************************************************************************
+#** Name: test.sh
+#** Purpose:  Builds ascii85 and checks converting many files with threads.
+#** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+#*******************************************************************************
+#** Date        User  Changelog
+#**-----------------------------------------------------------------------------
+#** 17.10.2026  JE    Created script, checks '-m' and errors of '-j'.
+#*******************************************************************************
+
+
+#*******************************************************************************
+#* setup
+
+cd "$(dirname "$0")" || exit 2
+
+g_tmp=$(mktemp -d)
+g_prog="$g_tmp/ascii85"
+g_fails=0
+trap 'rm -rf "$g_tmp"' EXIT
+
+gcc -Wall -Ofast -o "$g_prog" main.c -lpthread -lcrypto -lm || exit 2
+
+
+#*******************************************************************************
+#* functions
+
+#*******************************************************************************
+#* Name:  check
+#* Purpose: Prints result of a test and counts failed ones.
+#*******************************************************************************
+check() {
+  if [ "$2" = "$3" ]; then
+    echo "ok    $1"
+  else
+    echo "FAIL  $1: got '$2', expected '$3'"
+    g_fails=$((g_fails + 1))
+  fi
+}
+
+#*******************************************************************************
+#* Name:  peakMiB
+#* Purpose: Runs a command and prints its peak resident memory in MiB.
+#*******************************************************************************
+peakMiB() {
+  python3 -c '
+import resource, subprocess, sys
+subprocess.run(sys.argv[1:], stdout=subprocess.DEVNULL)
+print(resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss // 1024)
+' "$@"
+}
+
+
+#*******************************************************************************
+#* tests
+
+cd "$g_tmp" || exit 2
+
+# A slow head and many files smaller than a flush behind it.
+head -c 60000000 /dev/urandom | "$g_prog" -e > big.a85
+for i in $(seq -w 1 100); do
+  head -c 700000 /dev/urandom | "$g_prog" -e > small$i.a85
+done
+
+check "-j 4 gives same output as -j 1" \
+      "$("$g_prog" -j 4 -m 1000000 big.a85 small*.a85 | md5sum)" \
+      "$("$g_prog" -j 1 big.a85 small*.a85 | md5sum)"
+
+# 100 small files would be 70 MB, '-m' plus a flush per thread is allowed.
+iPeak=$(peakMiB "$g_prog" -j 4 -m 1000000 big.a85 small*.a85)
+check "-m 1000000 keeps small files from piling up (peak ${iPeak} MiB)" \
+      "$([ "$iPeak" -lt 32 ] && echo yes)" yes
+
+# Files before a failing one are printed, like without threads.
+printf 'hello' | "$g_prog" -e > a.a85
+printf 'world' | "$g_prog" -e > b.a85
+printf '<~87cURD]i,"Eb' > bad.a85
+
+for sArgs in "a.a85 big.a85 missing.a85 b.a85" "a.a85 b.a85 bad.a85 a.a85"; do
+  "$g_prog" -j 4 $sArgs > out4 2> /dev/null; iRv4=$?
+  "$g_prog" -j 1 $sArgs > out1 2> /dev/null; iRv1=$?
+  check "-j 4 fails after same output as -j 1 ($sArgs)" \
+        "$(md5sum < out4) $iRv4" "$(md5sum < out1) $iRv1"
+done
+
+exit $((g_fails > 0))
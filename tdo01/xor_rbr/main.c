@@ -1,26 +1,964 @@
+/*******************************************************************************
+ ** Name: xor_rbr
+ ** Purpose: Transforms every byte by a chain of bit operations.
+ ** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+ *******************************************************************************
+ ** Date        User  Log
+ **-----------------------------------------------------------------------------
+ ** 17.10.2026  JE    Changed it with the standard program skeleton.
+ ** 17.10.2026  JE    Added op chain '-x', '-a', '-s', '-r', '-l' and '-n'.
+ ** 17.10.2026  JE    Op chain is compiled into a table of all 256 bytes.
+ ** 17.10.2026  JE    Added SSSE3, AVX2 and AVX-512 kernels to apply the table.
+ ** 17.10.2026  JE    Pipes are streamed with read() and write() in big blocks.
+ ** 17.10.2026  JE    Added '-o' and '--in-place' to map files and transform
+ **                   them in parallel chunks, added '-j' for thread count.
+ ** 17.10.2026  JE    Added '--search' to rank all xor and rotate chains by
+ **                   how much the sample looks like plain text.
+ ** 17.10.2026  JE    Fixed default '-r 1' to rotate bit 0 into bit 7, the old
+ **                   code shifted it out, e.g. 0x54 gave 0x00 instead of 0x80.
+ *******************************************************************************/
+
+
+//******************************************************************************
+//* includes & namespaces
+
+#define _FILE_OFFSET_BITS 64  // Map files bigger than 2 GiB on 32 bit, too.
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XR_X86                // SIMD kernels, selected at runtime via cpuid.
+#include <immintrin.h>
+#endif
+
+#include "c_string.h"
+#include "c_dynamic_arrays_macros.h"
+
+
+//******************************************************************************
+//* me and myself
+
+#define ME_VERSION "0.4.1"
+cstr g_csMename;
+
+
+//******************************************************************************
+//* defines & macros
+
+#define ERR_NOERR 0x00
+#define ERR_ARGS  0x01
+#define ERR_FILE  0x02
+#define ERR_ELSE  0xff
+
+#define sERR_ARGS  "Argument error"
+#define sERR_FILE  "File error"
+#define sERR_ELSE  "Unknown error"
+
+// Ops of a transform chain.
+#define OP_XOR 0x00
+#define OP_ADD 0x01
+#define OP_SUB 0x02
+#define OP_ROR 0x03
+#define OP_ROL 0x04
+#define OP_NOT 0x05
+
+// Bytes transformed at once.
+#define BUF_SIZE (1024 * 1024)
+
+// Chunks of mapped files are aligned to this size, to keep threads apart.
+#define CHUNK_ALIGN 4096
+
+// Defaults of '--search'.
+#define SEARCH_SAMPLE (4 * 1024)
+#define SEARCH_TOP    10
+
+// Candidates are all xor keys with all rotations.
+#define CAND_KEYS 256
+#define CAND_ROTS 8
+
+
+//******************************************************************************
+//* outsourced standard functions, includes and defines
+
+#include "stdfcns.c"
+
+
+//******************************************************************************
+//* typedefs
+
+// One op of the chain and its value.
+typedef struct s_op {
+  int iOp;
+  int iVal;
+} t_op;
+
+s_array(cstr);
+s_array(t_op);
+
+// Arguments and options.
+typedef struct s_options {
+  t_array(t_op) tOps;
+  cstr          csOut;
+  int           iInPlace;
+  int           iThreads;
+  int           iSearch;
+  size_t        sSample;
+  int           iTop;
+  int           iReadStdin;
+} t_options;
+
+// Applies the table from source to destination, both may be the same.
+typedef struct s_kernel {
+  const char* pcName;
+  int  (*isSupported)(void);
+  void (*apply)(uchar* pucDst, const uchar* pucSrc, size_t sLen, const uchar* pucTable);
+} t_kernel;
+
+// Part of a mapped file, transformed by one thread.
+typedef struct s_job {
+  uchar*       pucDst;
+  const uchar* pucSrc;
+  size_t       sLen;
+} t_job;
+
+// Op chain '-x iKey -r iRot' and its plain text score.
+typedef struct s_cand {
+  int    iKey;
+  int    iRot;
+  double dScore;
+} t_cand;
+
+// Scores all keys of one or more rotations.
+typedef struct s_search {
+  const uint32_t* pui32Hist;
+  t_cand*         ptCands;
+  int             iFirst;
+  int             iStep;
+} t_search;
+
+
+//******************************************************************************
+//* Global variables
+
+// Arguments
+t_options     g_tOpts;  // CLI options and arguments.
+t_array(cstr) g_tArgs;  // Free arguments.
+
+// Transform of every byte.
+uchar g_aucTable[256];
+
+
+//******************************************************************************
+//* Functions
+
+/*******************************************************************************
+ * Name:  usage
+ * Purpose: Print help text and exit program.
+ *******************************************************************************/
+void usage(int iErr, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+
+  // Print at least one newline with message.
+  if (csMsg.len != 0)
+    csCat(&csMsg, csMsg.cStr, "\n\n");
+
+  csSetf(&csMsg, "%s"
+//|************************ 80 chars width ****************************************|
+  "usage: %s [-x n] [-a n] [-s n] [-r n] [-l n] [-n] [file1 file2 ...]\n"
+  "       %s [ops] [-j n] -o outfile file\n"
+  "       %s [ops] [-j n] --in-place file1 [file2 ...]\n"
+  "       %s --search [--sample n] [--top n] [-j n] [file]\n"
+  "       %s [-h|--help|-v|--version]\n"
+  " Transforms every byte of file(s) by a chain of ops in given order and prints\n"
+  " them to stdout. Data can also been piped into the program. Without any op\n"
+  " the chain is '-x 0x55 -r 1'.\n"
+  "  -x n:          xor with n\n"
+  "  -a n:          add n, modulo 256\n"
+  "  -s n:          subtract n, modulo 256\n"
+  "  -r n:          rotate bits right by n\n"
+  "  -l n:          rotate bits left by n\n"
+  "  -n:            invert all bits\n"
+  "  -o outfile:    map file and write transformed bytes to outfile\n"
+  "  -j n:          threads for '-o' and '--in-place' (default online cpus)\n"
+  "  --in-place:    map file(s) and transform them in place\n"
+  "  --search:      print op chains, which make the sample look most like text\n"
+  "  --sample n:    bytes of the sample (default 4K)\n"
+  "  --top n:       count of printed op chains (default 10)\n"
+  "  -h|--help:     print this help\n"
+  "  -v|--version:  print version of program\n"
+//|************************ 80 chars width ****************************************|
+         ,csMsg.cStr,
+         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr,
+         g_csMename.cStr
+        );
+
+  if (iErr == ERR_NOERR)
+    printf("%s", csMsg.cStr);
+  else
+    fprintf(stderr, "%s", csMsg.cStr);
+
+  csFree(&csMsg);
+
+  exit(iErr);
+}
+
+/*******************************************************************************
+ * Name:  dispatchError
+ * Purpose: Print out specific error message, if any occurres.
+ *******************************************************************************/
+void dispatchError(int rv, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+  cstr csErr = csNew("");
+
+  if (rv == ERR_NOERR) return;
+
+  if (rv == ERR_ARGS) csSet(&csErr, sERR_ARGS);
+  if (rv == ERR_FILE) csSet(&csErr, sERR_FILE);
+  if (rv == ERR_ELSE) csSet(&csErr, sERR_ELSE);
+
+  // Set to '<err>: <message>', if a message was given.
+  if (csMsg.len != 0) csSetf(&csErr, "%s: %s", csErr.cStr, csMsg.cStr);
+
+  usage(rv, csErr.cStr);
+}
+
+/*******************************************************************************
+ * Name:  addOp
+ * Purpose: Appends an op to the chain, its value is read from cli, if needed.
+ *******************************************************************************/
+void addOp(int iOp, int* piArg, int argc, char* argv[]) {
+  t_op tOp = {iOp, 0};
+
+  if (iOp != OP_NOT && ! getArgHexInt(&tOp.iVal, piArg, argc, argv, ARG_CLI, NULL))
+    dispatchError(ERR_ARGS, "No valid op value or missing");
+  if (tOp.iVal < 0 || tOp.iVal > 255)
+    dispatchError(ERR_ARGS, "Op value not within 0 ... 255");
 
+  daAdd(t_op, g_tOpts.tOps, tOp);
+}
+
+/*******************************************************************************
+ * Name:  getOptions
+ * Purpose: Filters command line.
+ *******************************************************************************/
+void getOptions(int argc, char* argv[]) {
+  cstr csArgv = csNew("");
+  int  iArg   = 1;  // Omit program name in arg loop.
+  int  iChar  = 0;
+  char cOpt   = 0;
+  t_op tOp    = {0};
+
+  // Set defaults.
+  g_tOpts.csOut      = csNew("");
+  g_tOpts.iInPlace   = 0;
+  g_tOpts.iThreads   = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  g_tOpts.iSearch    = 0;
+  g_tOpts.sSample    = SEARCH_SAMPLE;
+  g_tOpts.iTop       = SEARCH_TOP;
+  g_tOpts.iReadStdin = 0;
+
+  // Init free argument's and op chain's dynamic arrays.
+  daInit(cstr, g_tArgs);
+  daInit(t_op, g_tOpts.tOps);
 
-int processByte(int c) {
-  // XOR 0b01010101
-  // $b = $b ^ 0x55;
-  c = c ^ 0x55;
+  // Loop all arguments from command line POSIX style.
+  while (iArg < argc) {
+next_argument:
+    shift(&csArgv, &iArg, argc, argv);
+    if(strcmp(csArgv.cStr, "") == 0)
+      continue;
+
+    // Long options:
+    if (csArgv.cStr[0] == '-' && csArgv.cStr[1] == '-') {
+      if (!strcmp(csArgv.cStr, "--help")) {
+        usage(ERR_NOERR, "");
+      }
+      if (!strcmp(csArgv.cStr, "--version")) {
+        version();
+      }
+      if (!strcmp(csArgv.cStr, "--in-place")) {
+        g_tOpts.iInPlace = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--search")) {
+        g_tOpts.iSearch = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--sample")) {
+        if (! getArgHexLong((ll*) &g_tOpts.sSample, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No valid sample size or missing");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--top")) {
+        if (! getArgInt(&g_tOpts.iTop, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No valid top count or missing");
+        continue;
+      }
+      dispatchError(ERR_ARGS, "Invalid long option");
+    }
+
+    // Short options:
+    if (csArgv.cStr[0] == '-') {
+      for (iChar = 1; iChar < csArgv.len; ++iChar) {
+        cOpt = csArgv.cStr[iChar];
+        if (cOpt == 'h') {
+          usage(ERR_NOERR, "");
+        }
+        if (cOpt == 'v') {
+          version();
+        }
+        if (cOpt == 'x') {
+          addOp(OP_XOR, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 'a') {
+          addOp(OP_ADD, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 's') {
+          addOp(OP_SUB, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 'r') {
+          addOp(OP_ROR, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 'l') {
+          addOp(OP_ROL, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 'n') {
+          addOp(OP_NOT, &iArg, argc, argv);
+          continue;
+        }
+        if (cOpt == 'o') {
+          if (! getArgStr(&g_tOpts.csOut, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "Output file is missing");
+          continue;
+        }
+        if (cOpt == 'j') {
+          if (! getArgInt(&g_tOpts.iThreads, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid thread count or missing");
+          continue;
+        }
+        dispatchError(ERR_ARGS, "Invalid short option");
+      }
+      goto next_argument;
+    }
+    // Else, it's just a filename.
+    daAdd(cstr, g_tArgs, csNew(csArgv.cStr));
+  }
+
+  // Layer 1 of Tom's Data Onion, if no op was given. Rotates right, the
+  // onion's bytes have bit 0 cleared after the xor, so shifting worked, too.
+  if (g_tOpts.tOps.sCount == 0) {
+    tOp.iOp = OP_XOR; tOp.iVal = 0x55; daAdd(t_op, g_tOpts.tOps, tOp);
+    tOp.iOp = OP_ROR; tOp.iVal = 1;    daAdd(t_op, g_tOpts.tOps, tOp);
+  }
+
+  // Sanity check of arguments and flags.
+  if (g_tOpts.iThreads < 1) dispatchError(ERR_ARGS, "Thread count < 1");
+  if (g_tOpts.iInPlace && g_tOpts.csOut.len != 0)
+    dispatchError(ERR_ARGS, "Use either '-o' or '--in-place'");
+  if (g_tOpts.iInPlace && g_tArgs.sCount == 0)
+    dispatchError(ERR_ARGS, "'--in-place' needs file(s)");
+  if (g_tOpts.csOut.len != 0 && g_tArgs.sCount != 1)
+    dispatchError(ERR_ARGS, "'-o' needs exactly one file");
+  if (g_tOpts.iSearch && (g_tOpts.iInPlace || g_tOpts.csOut.len != 0))
+    dispatchError(ERR_ARGS, "'--search' doesn't write any output file");
+  if (g_tOpts.iSearch && g_tArgs.sCount > 1)
+    dispatchError(ERR_ARGS, "'--search' takes at most one file");
+  if ((ll) g_tOpts.sSample < 1) dispatchError(ERR_ARGS, "Sample size < 1");
+  if (g_tOpts.iTop < 1)         dispatchError(ERR_ARGS, "Top count < 1");
+
+  // Switch to stdin if no files were given.
+  if (g_tArgs.sCount == 0) g_tOpts.iReadStdin = 1;
+
+  // Free string memory.
+  csFree(&csArgv);
+}
 
-  // Right bit rotate.
-  // $b = $b >> 1 | (($b & 1) << 8);
-  c = (c >> 1) | ((c & 1) << 8);
+
+//******************************************************************************
+//*** table
+
+/*******************************************************************************
+ * Name:  processByte
+ * Purpose: Transforms one byte by all ops of the chain.
+ *******************************************************************************/
+uchar processByte(uchar c) {
+  for (size_t i = 0; i < g_tOpts.tOps.sCount; ++i) {
+    int iVal = g_tOpts.tOps.pVal[i].iVal;
+
+    switch (g_tOpts.tOps.pVal[i].iOp) {
+      case OP_XOR: c ^= iVal;                                              break;
+      case OP_ADD: c += iVal;                                              break;
+      case OP_SUB: c -= iVal;                                              break;
+      case OP_ROR: iVal &= 7; c = (uchar) (c >> iVal | c << ((8 - iVal) & 7)); break;
+      case OP_ROL: iVal &= 7; c = (uchar) (c << iVal | c >> ((8 - iVal) & 7)); break;
+      case OP_NOT: c = ~c;                                                 break;
+    }
+  }
 
   return c;
 }
 
+/*******************************************************************************
+ * Name:  compileTable
+ * Purpose: Runs the chain once for every byte value, so applying it is just
+ *          a lookup, regardless how long the chain is.
+ *******************************************************************************/
+void compileTable(void) {
+  for (int b = 0; b < 256; ++b) g_aucTable[b] = processByte((uchar) b);
+}
+
+//*** table
+//******************************************************************************
+
+
+//******************************************************************************
+//*** kernels
+
+/*******************************************************************************
+ * Name:  applyScalar
+ * Purpose: Looks up every byte in the table.
+ *******************************************************************************/
+void applyScalar(uchar* pucDst, const uchar* pucSrc, size_t sLen, const uchar* pucTable) {
+  for (size_t i = 0; i < sLen; ++i) pucDst[i] = pucTable[pucSrc[i]];
+}
+
+#ifdef XR_X86
+
+/*******************************************************************************
+ * Name:  applySsse3
+ * Purpose: Splits bytes into nibbles. Row h of the table is a pshufb of the
+ *          low nibbles, taken where the high nibble equals h.
+ *******************************************************************************/
+__attribute__((target("ssse3")))
+void applySsse3(uchar* pucDst, const uchar* pucSrc, size_t sLen, const uchar* pucTable) {
+  const __m128i xLow = _mm_set1_epi8(0x0f);
+  __m128i       axRow[16];
+  size_t        i    = 0;
+
+  for (int h = 0; h < 16; ++h) axRow[h] = _mm_loadu_si128((const __m128i*) (pucTable + 16 * h));
+
+  for (i = 0; i + 16 <= sLen; i += 16) {
+    __m128i xIn  = _mm_loadu_si128((const __m128i*) (pucSrc + i));
+    __m128i xLo  = _mm_and_si128(xIn, xLow);
+    __m128i xHi  = _mm_and_si128(_mm_srli_epi16(xIn, 4), xLow);
+    __m128i xOut = _mm_setzero_si128();
+
+    for (int h = 0; h < 16; ++h)
+      xOut = _mm_or_si128(xOut, _mm_and_si128(_mm_shuffle_epi8(axRow[h], xLo),
+                                              _mm_cmpeq_epi8(xHi, _mm_set1_epi8(h))));
+    _mm_storeu_si128((__m128i*) (pucDst + i), xOut);
+  }
+
+  applyScalar(pucDst + i, pucSrc + i, sLen - i, pucTable);
+}
+
+/*******************************************************************************
+ * Name:  applyAvx2
+ * Purpose: Like applySsse3(), but with 32 bytes per step.
+ *******************************************************************************/
+__attribute__((target("avx2")))
+void applyAvx2(uchar* pucDst, const uchar* pucSrc, size_t sLen, const uchar* pucTable) {
+  const __m256i yLow = _mm256_set1_epi8(0x0f);
+  __m256i       ayRow[16];
+  size_t        i    = 0;
 
-int main() {
-  int c = 0;
+  for (int h = 0; h < 16; ++h)
+    ayRow[h] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (pucTable + 16 * h)));
 
-  while ((c = getchar()) != EOF) {
-    c = processByte(c);
-    putchar(c);
+  for (i = 0; i + 32 <= sLen; i += 32) {
+    __m256i yIn  = _mm256_loadu_si256((const __m256i*) (pucSrc + i));
+    __m256i yLo  = _mm256_and_si256(yIn, yLow);
+    __m256i yHi  = _mm256_and_si256(_mm256_srli_epi16(yIn, 4), yLow);
+    __m256i yOut = _mm256_setzero_si256();
+
+    for (int h = 0; h < 16; ++h)
+      yOut = _mm256_or_si256(yOut, _mm256_and_si256(_mm256_shuffle_epi8(ayRow[h], yLo),
+                                                    _mm256_cmpeq_epi8(yHi, _mm256_set1_epi8(h))));
+    _mm256_storeu_si256((__m256i*) (pucDst + i), yOut);
   }
+
+  applyScalar(pucDst + i, pucSrc + i, sLen - i, pucTable);
 }
 
+/*******************************************************************************
+ * Name:  applyAvx512
+ * Purpose: Looks up 64 bytes in both halves of the table with vpermi2b and
+ *          takes the upper one, where bit 7 is set.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+void applyAvx512(uchar* pucDst, const uchar* pucSrc, size_t sLen, const uchar* pucTable) {
+  const __m512i zT0 = _mm512_loadu_si512((const void*) (pucTable +   0));
+  const __m512i zT1 = _mm512_loadu_si512((const void*) (pucTable +  64));
+  const __m512i zT2 = _mm512_loadu_si512((const void*) (pucTable + 128));
+  const __m512i zT3 = _mm512_loadu_si512((const void*) (pucTable + 192));
+  size_t        i   = 0;
+
+  for (i = 0; i + 64 <= sLen; i += 64) {
+    __m512i zIn = _mm512_loadu_si512((const void*) (pucSrc + i));
+    __m512i zLo = _mm512_permutex2var_epi8(zT0, zIn, zT1);
+    __m512i zHi = _mm512_permutex2var_epi8(zT2, zIn, zT3);
+    _mm512_storeu_si512((void*) (pucDst + i), _mm512_mask_blend_epi8(_mm512_movepi8_mask(zIn), zLo, zHi));
+  }
+
+  applyScalar(pucDst + i, pucSrc + i, sLen - i, pucTable);
+}
+
+/*******************************************************************************
+ * Name:  hasSsse3
+ * Purpose: Checks via cpuid, if SSSE3 kernel can run on this host.
+ *******************************************************************************/
+int hasSsse3(void) {
+  return __builtin_cpu_supports("ssse3");
+}
+
+/*******************************************************************************
+ * Name:  hasAvx2
+ * Purpose: Checks via cpuid, if AVX2 kernel can run on this host.
+ *******************************************************************************/
+int hasAvx2(void) {
+  return __builtin_cpu_supports("avx2");
+}
+
+/*******************************************************************************
+ * Name:  hasAvx512
+ * Purpose: Checks via cpuid, if AVX-512 kernel with byte permutes can run.
+ *******************************************************************************/
+int hasAvx512(void) {
+  return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("avx512vbmi");
+}
+
+#endif // XR_X86
+
+/*******************************************************************************
+ * Name:  hasScalar
+ * Purpose: Scalar kernel runs everywhere.
+ *******************************************************************************/
+int hasScalar(void) {
+  return 1;
+}
+
+// All kernels, the last one supported by the host is used.
+t_kernel g_atKernels[] = {
+  {"scalar", hasScalar, applyScalar},
+#ifdef XR_X86
+  {"ssse3",  hasSsse3,  applySsse3},
+  {"avx2",   hasAvx2,   applyAvx2},
+  {"avx512", hasAvx512, applyAvx512},
+#endif
+};
+
+// Kernel in use.
+t_kernel* g_ptKernel = &g_atKernels[0];
+
+/*******************************************************************************
+ * Name:  selectKernel
+ * Purpose: Selects the newest kernel supported by this host.
+ *******************************************************************************/
+void selectKernel(void) {
+  for (size_t i = 0; i < arraySize(g_atKernels); ++i)
+    if (g_atKernels[i].isSupported()) g_ptKernel = &g_atKernels[i];
+}
+
+//*** kernels
+//******************************************************************************
+
+
+//******************************************************************************
+//*** io
+
+/*******************************************************************************
+ * Name:  writeBlock
+ * Purpose: Writes all bytes, even if the pipe takes only a part at once.
+ *******************************************************************************/
+void writeBlock(int iFd, const uchar* pucBuf, size_t sLen) {
+  ssize_t sWritten = 0;
+
+  while (sLen > 0) {
+    if ((sWritten = write(iFd, pucBuf, sLen)) < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error writing output");
+    }
+    pucBuf += sWritten;
+    sLen   -= sWritten;
+  }
+}
+
+/*******************************************************************************
+ * Name:  streamFile
+ * Purpose: Transforms a stream block by block, without stdio in between.
+ *******************************************************************************/
+void streamFile(int iFdIn, int iFdOut) {
+  uchar*  pucBuf = (uchar*) malloc(BUF_SIZE);
+  ssize_t sRead  = 0;
+
+  if (! pucBuf) dispatchError(ERR_ELSE, "Out of memory");
+
+  while ((sRead = read(iFdIn, pucBuf, BUF_SIZE)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    g_ptKernel->apply(pucBuf, pucBuf, sRead, g_aucTable);
+    writeBlock(iFdOut, pucBuf, sRead);
+  }
+
+  free(pucBuf);
+}
+
+/*******************************************************************************
+ * Name:  transformJob
+ * Purpose: Thread function, transforms one part of a mapped file.
+ *******************************************************************************/
+void* transformJob(void* pvJob) {
+  t_job* ptJob = (t_job*) pvJob;
+
+  g_ptKernel->apply(ptJob->pucDst, ptJob->pucSrc, ptJob->sLen, g_aucTable);
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  transformParallel
+ * Purpose: Splits mapped bytes into one part per thread. Parts are page
+ *          aligned, so no two threads write into the same page.
+ *******************************************************************************/
+void transformParallel(uchar* pucDst, const uchar* pucSrc, size_t sLen) {
+  size_t     sThreads = g_tOpts.iThreads;
+  size_t     sPart    = 0;
+  t_job*     ptJobs   = NULL;
+  pthread_t* ptThread = NULL;
+
+  // Small files are not worth spawning threads.
+  if (sLen < (size_t) BUF_SIZE || sThreads == 1) {
+    g_ptKernel->apply(pucDst, pucSrc, sLen, g_aucTable);
+    return;
+  }
+
+  sPart    = (sLen / sThreads + CHUNK_ALIGN - 1) & ~((size_t) CHUNK_ALIGN - 1);
+  ptJobs   = (t_job*)     malloc(sThreads * sizeof(t_job));
+  ptThread = (pthread_t*) malloc(sThreads * sizeof(pthread_t));
+  if (! ptJobs || ! ptThread) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (size_t t = 0; t < sThreads; ++t) {
+    size_t sBeg = t * sPart < sLen ? t * sPart : sLen;
+    size_t sEnd = sBeg + sPart < sLen ? sBeg + sPart : sLen;
+
+    ptJobs[t].pucDst = pucDst + sBeg;
+    ptJobs[t].pucSrc = pucSrc + sBeg;
+    ptJobs[t].sLen   = sEnd - sBeg;
+    if (pthread_create(&ptThread[t], NULL, transformJob, &ptJobs[t]))
+      dispatchError(ERR_ELSE, "Can't create thread");
+  }
+  for (size_t t = 0; t < sThreads; ++t) pthread_join(ptThread[t], NULL);
+
+  free(ptThread);
+  free(ptJobs);
+}
+
+/*******************************************************************************
+ * Name:  mapFile
+ * Purpose: Maps a whole file or throws an error.
+ *******************************************************************************/
+uchar* mapFile(int iFd, size_t sLen, int iProt) {
+  void* pvMap = mmap(NULL, sLen, iProt, MAP_SHARED, iFd, 0);
+
+  if (pvMap == MAP_FAILED) dispatchError(ERR_FILE, "Can't map file");
+  madvise(pvMap, sLen, MADV_SEQUENTIAL);
+
+  return (uchar*) pvMap;
+}
+
+/*******************************************************************************
+ * Name:  transformInPlace
+ * Purpose: Maps a regular file writable and transforms it where it is.
+ *******************************************************************************/
+void transformInPlace(const char* pcName) {
+  FILE*       hFile  = openFile(pcName, "r+b");
+  struct stat tStat  = {0};
+  uchar*      pucMap = NULL;
+
+  if (fstat(fileno(hFile), &tStat) != 0 || ! S_ISREG(tStat.st_mode))
+    dispatchError(ERR_FILE, "'--in-place' needs regular file(s)");
+
+  // Empty files can't be mapped, but there is nothing to do anyway.
+  if (tStat.st_size > 0) {
+    pucMap = mapFile(fileno(hFile), tStat.st_size, PROT_READ | PROT_WRITE);
+    transformParallel(pucMap, pucMap, tStat.st_size);
+    munmap(pucMap, tStat.st_size);
+  }
+
+  fclose(hFile);
+}
+
+/*******************************************************************************
+ * Name:  transformToFile
+ * Purpose: Maps input and output file and transforms from one to the other.
+ *          Input, which is no regular file, is streamed into output instead.
+ *******************************************************************************/
+void transformToFile(const char* pcIn, const char* pcOut) {
+  FILE*       hIn      = openFile(pcIn, "rb");
+  FILE*       hOut     = NULL;
+  struct stat tStatIn  = {0};
+  struct stat tStatOut = {0};
+  uchar*      pucIn    = NULL;
+  uchar*      pucOut   = NULL;
+
+  if (fstat(fileno(hIn), &tStatIn) != 0)
+    dispatchError(ERR_FILE, "Can't stat input file");
+
+  // Truncating output would destroy input, too.
+  if (stat(pcOut, &tStatOut) == 0 && tStatOut.st_dev == tStatIn.st_dev &&
+      tStatOut.st_ino == tStatIn.st_ino)
+    dispatchError(ERR_ARGS, "Output is input, use '--in-place'");
+
+  hOut = openFile(pcOut, "w+b");
+
+  if (! S_ISREG(tStatIn.st_mode)) {
+    streamFile(fileno(hIn), fileno(hOut));
+  }
+  else if (tStatIn.st_size > 0) {
+    if (ftruncate(fileno(hOut), tStatIn.st_size) != 0)
+      dispatchError(ERR_FILE, "Can't resize output file");
+    pucIn  = mapFile(fileno(hIn),  tStatIn.st_size, PROT_READ);
+    pucOut = mapFile(fileno(hOut), tStatIn.st_size, PROT_READ | PROT_WRITE);
+    transformParallel(pucOut, pucIn, tStatIn.st_size);
+    munmap(pucOut, tStatIn.st_size);
+    munmap(pucIn,  tStatIn.st_size);
+  }
+
+  fclose(hOut);
+  fclose(hIn);
+}
+
+//*** io
+//******************************************************************************
+
+
+//******************************************************************************
+//*** search
+
+/*******************************************************************************
+ * Name:  readSample
+ * Purpose: Reads up to sMax bytes from a stream, returns count read.
+ *******************************************************************************/
+size_t readSample(int iFd, uchar* pucBuf, size_t sMax) {
+  size_t  sLen  = 0;
+  ssize_t sRead = 0;
+
+  while (sLen < sMax && (sRead = read(iFd, pucBuf + sLen, sMax - sLen)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    sLen += sRead;
+  }
+
+  return sLen;
+}
+
+/*******************************************************************************
+ * Name:  countBytes
+ * Purpose: Counts every byte value. Four banks of counters are filled in
+ *          turn, so consecutive equal bytes don't wait on the same counter.
+ *******************************************************************************/
+void countBytes(uint32_t* pui32Hist, const uchar* pucBuf, size_t sLen) {
+  uint32_t aui32Bank[4][256] = {{0}};
+  size_t   i                 = 0;
+
+  for (i = 0; i + 4 <= sLen; i += 4) {
+    ++aui32Bank[0][pucBuf[i + 0]];
+    ++aui32Bank[1][pucBuf[i + 1]];
+    ++aui32Bank[2][pucBuf[i + 2]];
+    ++aui32Bank[3][pucBuf[i + 3]];
+  }
+  for (; i < sLen; ++i) ++aui32Bank[0][pucBuf[i]];
+
+  for (int b = 0; b < 256; ++b)
+    pui32Hist[b] = aui32Bank[0][b] + aui32Bank[1][b] + aui32Bank[2][b] + aui32Bank[3][b];
+}
+
+// Plain text weight of every byte value, see initWeights().
+double g_adWeight[256];
+
+/*******************************************************************************
+ * Name:  initWeights
+ * Purpose: Letters weigh with their frequency in English text, other
+ *          printable chars a bit, everything else is a penalty.
+ *******************************************************************************/
+void initWeights(void) {
+  const double adFreq[26] = {
+    8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+    6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074
+  };
+
+  for (int b = 0; b < 256; ++b) {
+    if      (b >= 'a' && b <= 'z')                   g_adWeight[b] = adFreq[b - 'a'];
+    else if (b >= 'A' && b <= 'Z')                   g_adWeight[b] = adFreq[b - 'A'];
+    else if (b == ' ')                               g_adWeight[b] = 13.0;
+    else if (b >= 0x21 && b <= 0x7e)                 g_adWeight[b] = 1.0;
+    else if (b == '\n' || b == '\r' || b == '\t') g_adWeight[b] = 1.0;
+    else                                             g_adWeight[b] = -20.0;
+  }
+}
+
+/*******************************************************************************
+ * Name:  scoreRotations
+ * Purpose: Thread function, scores all keys of every iStep'th rotation.
+ *          A chain maps equal bytes to equal bytes, so the score of the
+ *          sample is taken from its histogram, not from the sample itself.
+ *******************************************************************************/
+void* scoreRotations(void* pvSearch) {
+  t_search* ptSearch = (t_search*) pvSearch;
+
+  for (int iRot = ptSearch->iFirst; iRot < CAND_ROTS; iRot += ptSearch->iStep) {
+    for (int iKey = 0; iKey < CAND_KEYS; ++iKey) {
+      t_cand* ptCand = &ptSearch->ptCands[iRot * CAND_KEYS + iKey];
+      double  dScore = 0.0;
+
+      for (int b = 0; b < 256; ++b) {
+        uchar c = (uchar) (b ^ iKey);
+        c       = (uchar) (c >> iRot | c << ((8 - iRot) & 7));
+        dScore += ptSearch->pui32Hist[b] * g_adWeight[c];
+      }
+      ptCand->iKey   = iKey;
+      ptCand->iRot   = iRot;
+      ptCand->dScore = dScore;
+    }
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  cmpCands
+ * Purpose: Sorts candidates by descending score.
+ *******************************************************************************/
+int cmpCands(const void* pvA, const void* pvB) {
+  double dA = ((const t_cand*) pvA)->dScore;
+  double dB = ((const t_cand*) pvB)->dScore;
+
+  return (dA < dB) - (dA > dB);
+}
+
+/*******************************************************************************
+ * Name:  searchChains
+ * Purpose: Scores all chains '-x key -r rot' on a sample and prints the best.
+ *          Other chains of xor, rotate and not are left out on purpose,
+ *          'rot' then 'xor' is 'xor' with rotated key then 'rot', and 'not'
+ *          is 'xor 0xff'.
+ *******************************************************************************/
+void searchChains(int iFd) {
+  uchar*     pucSample = (uchar*) malloc(g_tOpts.sSample);
+  size_t     sLen      = 0;
+  uint32_t   aui32Hist[256];
+  t_cand     atCands[CAND_KEYS * CAND_ROTS];
+  int        iThreads  = g_tOpts.iThreads < CAND_ROTS ? g_tOpts.iThreads : CAND_ROTS;
+  t_search   atSearch[CAND_ROTS];
+  pthread_t  atThread[CAND_ROTS];
+
+  if (! pucSample) dispatchError(ERR_ELSE, "Out of memory");
+
+  sLen = readSample(iFd, pucSample, g_tOpts.sSample);
+  if (sLen == 0) dispatchError(ERR_FILE, "No data to search");
+
+  countBytes(aui32Hist, pucSample, sLen);
+  initWeights();
+
+  for (int t = 0; t < iThreads; ++t) {
+    atSearch[t].pui32Hist = aui32Hist;
+    atSearch[t].ptCands   = atCands;
+    atSearch[t].iFirst    = t;
+    atSearch[t].iStep     = iThreads;
+    if (pthread_create(&atThread[t], NULL, scoreRotations, &atSearch[t]))
+      dispatchError(ERR_ELSE, "Can't create thread");
+  }
+  for (int t = 0; t < iThreads; ++t) pthread_join(atThread[t], NULL);
+
+  qsort(atCands, arraySize(atCands), sizeof(t_cand), cmpCands);
+
+  // Score is printed per byte of sample, to compare different sample sizes.
+  for (int i = 0; i < g_tOpts.iTop && i < (int) arraySize(atCands); ++i)
+    printf("%8.3f  -x 0x%02x -r %d\n", atCands[i].dScore / sLen,
+           atCands[i].iKey, atCands[i].iRot);
+
+  free(pucSample);
+}
+
+//*** search
+//******************************************************************************
+
+
+//******************************************************************************
+//* main
+
+int main(int argc, char *argv[]) {
+  FILE* hFile  = NULL;
+  int   iStdin = 0;
+
+  // Save program's name.
+  g_csMename = csNew("");
+  getMename(&g_csMename, argv[0]);
+
+  // Get options and dispatch errors, if any.
+  getOptions(argc, argv);
+
+  // Compile op chain and use the fastest kernel to apply it.
+  compileTable();
+  selectKernel();
+
+  // Search op chains in a sample of the first file or stdin.
+  if (g_tOpts.iSearch) {
+    hFile = g_tOpts.iReadStdin ? stdin : openFile(g_tArgs.pVal[0].cStr, "rb");
+    searchChains(fileno(hFile));
+    fclose(hFile);
+  }
+  // Mapped modes work on files directly.
+  else if (g_tOpts.iInPlace) {
+    for (int i = 0; i < g_tArgs.sCount; ++i) transformInPlace(g_tArgs.pVal[i].cStr);
+    iStdin = 0;
+  }
+  else if (g_tOpts.csOut.len != 0) {
+    transformToFile(g_tArgs.pVal[0].cStr, g_tOpts.csOut.cStr);
+    iStdin = 0;
+  }
+  else {
+    // If to use stdin instead of files, say so.
+    iStdin = g_tOpts.iReadStdin;
+
+    // Get all data from all files, or stdin.
+    for (int i = 0; i < g_tArgs.sCount || iStdin; ++i) {
+      if (iStdin) {
+        hFile  = stdin;
+        iStdin = 0;
+      }
+      else {
+        hFile = openFile(g_tArgs.pVal[i].cStr, "rb");
+      }
+//-- file ----------------------------------------------------------------------
+      streamFile(fileno(hFile), STDOUT_FILENO);
+//-- file ----------------------------------------------------------------------
+      fclose(hFile);
+    }
+  }
+
+  // Free all used memory, prior end of program.
+  daFreeEx(g_tArgs, cStr);
+  daFree(g_tOpts.tOps);
+  csFree(&g_tOpts.csOut);
+
+  return ERR_NOERR;
+}
@@ -0,0 +1,69 @@
+#!/bin/bash
+#*******************************************************************************
+#** Name: test.sh
+#** Purpose:  Builds xor_rbr and checks its default op chain.
+#** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+#*******************************************************************************
+#** Date        User  Changelog
+#**-----------------------------------------------------------------------------
+#** 17.10.2026  JE    Created script, checks '-x 0x55 -r 1' rotates bit 0.
+#*******************************************************************************
+
+
+#*******************************************************************************
+#* setup
+
+cd "$(dirname "$0")" || exit 2
+
+g_tmp=$(mktemp -d)
+g_prog="$g_tmp/xor_rbr"
+g_fails=0
+trap 'rm -rf "$g_tmp"' EXIT
+
+gcc -Wall -Ofast -o "$g_prog" main.c -lpthread -lm || exit 2
+
+
+#*******************************************************************************
+#* functions
+
+#*******************************************************************************
+#* Name:  check
+#* Purpose: Prints result of a test and counts failed ones.
+#*******************************************************************************
+check() {
+  if [ "$2" = "$3" ]; then
+    echo "ok    $1"
+  else
+    echo "FAIL  $1: got '$2', expected '$3'"
+    g_fails=$((g_fails + 1))
+  fi
+}
+
+#*******************************************************************************
+#* Name:  hexOf
+#* Purpose: Prints bytes of stdin as hex without spaces.
+#*******************************************************************************
+hexOf() {
+  od -An -v -tx1 | tr -d ' \n'
+}
+
+
+#*******************************************************************************
+#* tests
+
+# 0x54 ^ 0x55 is 0x01, bit 0 rotates into bit 7, shifting would give 0x00.
+check "default chain rotates bit 0 into bit 7" \
+      "$(printf '\x54\x55\xff\x00' | "$g_prog" | hexOf)" "800055aa"
+
+# All bytes, expected by xor and rotate right by 1 in bash.
+sAll=""
+sWant=""
+for ((c = 0; c < 256; ++c)); do
+  sAll+=$(printf '\\x%02x' $c)
+  sWant+=$(printf '%02x' $(( ((c ^ 0x55) >> 1) | (((c ^ 0x55) & 1) << 7) )))
+done
+check "default chain on all bytes" "$(printf "$sAll" | "$g_prog" | hexOf)" "$sWant"
+check "'-x 0x55 -r 1' on all bytes" \
+      "$(printf "$sAll" | "$g_prog" -x 0x55 -r 1 | hexOf)" "$sWant"
+
+exit $((g_fails > 0))
@@ -1,69 +1,1001 @@
+/*******************************************************************************
+ ** Name: parityodd
+ ** Purpose: Drops bytes with wrong parity and packs the 7 data bits of the
+ **          remaining ones.
+ ** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+ *******************************************************************************
+ ** Date        User  Log
+ **-----------------------------------------------------------------------------
+ ** 17.10.2026  JE    Changed it with the standard program skeleton.
+ ** 17.10.2026  JE    Reads and writes in big blocks instead of per byte.
+ ** 17.10.2026  JE    Added AVX2 and AVX-512 kernels, which filter 32 or 64
+ **                   bytes at once and compact the good ones.
+ ** 17.10.2026  JE    Added BMI2 kernels, which pack 8 to 7 bytes with pext
+ **                   and encode 7 to 8 bytes with pdep and parity bits.
+ ** 17.10.2026  JE    Added '-e' to encode data and '--bench' for throughput.
+ ** 17.10.2026  JE    Packers are generated by macro for every layout, added
+ **                   '-p', '-b' and '--msb' to select one.
+ ** 17.10.2026  JE    Added '--rejects' to write a bitmap of dropped bytes and
+ **                   '--stats' to print drops per MiB and bytes left at EOF.
+ *******************************************************************************/
+
+
+//******************************************************************************
+//* includes & namespaces
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PO_X86                // SIMD kernels, selected at runtime via cpuid.
+#include <immintrin.h>
+#endif
+
+#include "c_string.h"
+#include "c_dynamic_arrays_macros.h"
+
+
+//******************************************************************************
+//* me and myself
+
+#define ME_VERSION "0.5.0"
+cstr g_csMename;
+
+
+//******************************************************************************
+//* defines & macros
+
+#define ERR_NOERR 0x00
+#define ERR_ARGS  0x01
+#define ERR_FILE  0x02
+#define ERR_ELSE  0xff
+
+#define sERR_ARGS  "Argument error"
+#define sERR_FILE  "File error"
+#define sERR_ELSE  "Unknown error"
 
-#define PARITY_EVEN (0)
-#define PARITY_ODD  (!0)
+// Bytes read at once, blocks are full with '--rejects' or '--stats'.
+#define BUF_SIZE (1024 * 1024)
 
-typedef unsigned char uchar;
+// Filter kernels may store up to this many bytes behind the last good one.
+#define BUF_SLACK 64
 
-// Converter struct for 64 bits minus 7 bits parity = 7 bytes.
-typedef union u_bb {
-  int64_t i64Int;
-  uchar   aBytes[8];
-} t_bb;
+// 8 good bytes hold 8 * n data bits = n bytes of data.
+#define GROUP_IN 8
+#define BITS_MIN 5
+#define BITS_MAX 7
 
+// Data bits of 8 bytes with n data bits, shifted over the parity bit.
+#define DATA_MASK(bits, shift) (0x0101010101010101ULL * (((1ULL << (bits)) - 1) << (shift)))
+
+// Size of random test data for benchmark.
+#define BENCH_SIZE (64 * 1024 * 1024)
+
+
+//******************************************************************************
+//* outsourced standard functions, includes and defines
+
+#include "stdfcns.c"
+
+
+//******************************************************************************
+//* typedefs
+
+s_array(cstr);
+s_array(size_t);
+
+// Arguments and options.
+typedef struct s_options {
+  cstr csRejects;
+  int  iStats;
+  int  iOdd;
+  int  iMsb;
+  int  iBits;
+  int  iEncode;
+  int  iBench;
+  int  iReadStdin;
+} t_options;
+
+// Copies bytes with even (or odd) parity from source to destination, returns
+// count. Sets a bit in mask for every dropped byte, if mask is not NULL.
+typedef struct s_filter {
+  const char* pcName;
+  int    (*isSupported)(void);
+  size_t (*filter)(uchar* pucDst, const uchar* pucSrc, size_t sLen, int iOdd, uchar* pucMask);
+} t_filter;
+
+// Packs groups of 8 good bytes into n, or encodes groups of n into 8.
+typedef struct s_packer {
+  const char* pcName;
+  int    (*isSupported)(void);
+  size_t (*pack)(uchar* pucDst, const uchar* pucSrc, size_t sGroups);
+  size_t (*encode)(uchar* pucDst, const uchar* pucSrc, size_t sGroups);
+} t_packer;
+
+// Packers of one layout: data bits per byte, parity bit position and parity.
+typedef struct s_layout {
+  int      iBits;
+  int      iMsb;
+  int      iOdd;
+  t_packer atPackers[2];
+} t_layout;
+
+// Drops of one file.
+typedef struct s_stats {
+  t_array(size_t) tDrops;    // Dropped bytes per block of BUF_SIZE.
+  size_t          sBytes;
+  size_t          sDropped;
+  size_t          sLeft;     // Good bytes of incomplete group at EOF.
+} t_stats;
+
+
+//******************************************************************************
+//* Global variables
+
+// Arguments
+t_options     g_tOpts;  // CLI options and arguments.
+t_array(cstr) g_tArgs;  // Free arguments.
+
+
+//******************************************************************************
+//* Functions
+
+/*******************************************************************************
+ * Name:  usage
+ * Purpose: Print help text and exit program.
+ *******************************************************************************/
+void usage(int iErr, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+
+  // Print at least one newline with message.
+  if (csMsg.len != 0)
+    csCat(&csMsg, csMsg.cStr, "\n\n");
+
+  csSetf(&csMsg, "%s"
+//|************************ 80 chars width ****************************************|
+  "usage: %s [-e] [-p even|odd] [-b n] [--msb] [file1 file2 ...]\n"
+  "       %s [layout] [--rejects bitmap] [--stats] [file]\n"
+  "       %s [--bench] [-p even|odd] [-b n] [--msb]\n"
+  "       %s [-h|--help|-v|--version]\n"
+  " Drops all bytes of file(s) with wrong parity. The data bits of every 8 left\n"
+  " bytes are packed into n bytes and printed to stdout. Data can also been piped\n"
+  " into the program.\n"
+  "  -e:            encode, every n bytes become 8 bytes with parity, the last\n"
+  "                 group is padded with zeros\n"
+  "  -p even|odd:   keep bytes with even (default) or odd count of set bits\n"
+  "  -b n:          data bits per byte, 5, 6 or 7 (default), next to parity bit\n"
+  "  --msb:         parity bit is bit 7 and data bits are the lowest, instead of\n"
+  "                 parity bit 0 and data bits above\n"
+  "  --rejects bitmap: write one bit per input byte, set if it was dropped,\n"
+  "                 lowest bit first\n"
+  "  --stats:       print dropped bytes per MiB and bytes left over at EOF to\n"
+  "                 stderr\n"
+  "  --bench:       print speed of all kernels supported by this CPU\n"
+  "  -h|--help:     print this help\n"
+  "  -v|--version:  print version of program\n"
+//|************************ 80 chars width ****************************************|
+         ,csMsg.cStr,
+         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr
+        );
+
+  if (iErr == ERR_NOERR)
+    printf("%s", csMsg.cStr);
+  else
+    fprintf(stderr, "%s", csMsg.cStr);
+
+  csFree(&csMsg);
+
+  exit(iErr);
+}
+
+/*******************************************************************************
+ * Name:  dispatchError
+ * Purpose: Print out specific error message, if any occurres.
+ *******************************************************************************/
+void dispatchError(int rv, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+  cstr csErr = csNew("");
+
+  if (rv == ERR_NOERR) return;
+
+  if (rv == ERR_ARGS) csSet(&csErr, sERR_ARGS);
+  if (rv == ERR_FILE) csSet(&csErr, sERR_FILE);
+  if (rv == ERR_ELSE) csSet(&csErr, sERR_ELSE);
+
+  // Set to '<err>: <message>', if a message was given.
+  if (csMsg.len != 0) csSetf(&csErr, "%s: %s", csErr.cStr, csMsg.cStr);
+
+  usage(rv, csErr.cStr);
+}
 
 /*******************************************************************************
- * Name:  getParity
- * Purpose: Calculates the bit-parity of the given integer.
- * URL: https://www.geeksforgeeks.org/program-to-find-parity/
+ * Name:  getOptions
+ * Purpose: Filters command line.
  *******************************************************************************/
-int getParity(int c) {
-  int iParity = 0;
+void getOptions(int argc, char* argv[]) {
+  cstr csArgv = csNew("");
+  cstr csRv   = csNew("");
+  int  iArg   = 1;  // Omit program name in arg loop.
+  int  iChar  = 0;
+  char cOpt   = 0;
+
+  // Set defaults.
+  g_tOpts.csRejects  = csNew("");
+  g_tOpts.iStats     = 0;
+  g_tOpts.iOdd       = 0;
+  g_tOpts.iMsb       = 0;
+  g_tOpts.iBits      = BITS_MAX;
+  g_tOpts.iEncode    = 0;
+  g_tOpts.iBench     = 0;
+  g_tOpts.iReadStdin = 0;
+
+  // Init free argument's dynamic array.
+  daInit(cstr, g_tArgs);
 
-  while (c) {
-    iParity = !iParity;
-    c       = c & (c - 1);
+  // Loop all arguments from command line POSIX style.
+  while (iArg < argc) {
+next_argument:
+    shift(&csArgv, &iArg, argc, argv);
+    if(strcmp(csArgv.cStr, "") == 0)
+      continue;
+
+    // Long options:
+    if (csArgv.cStr[0] == '-' && csArgv.cStr[1] == '-') {
+      if (!strcmp(csArgv.cStr, "--help")) {
+        usage(ERR_NOERR, "");
+      }
+      if (!strcmp(csArgv.cStr, "--version")) {
+        version();
+      }
+      if (!strcmp(csArgv.cStr, "--bench")) {
+        g_tOpts.iBench = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--msb")) {
+        g_tOpts.iMsb = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--rejects")) {
+        if (! getArgStr(&g_tOpts.csRejects, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "Bitmap file is missing");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--stats")) {
+        g_tOpts.iStats = 1;
+        continue;
+      }
+      dispatchError(ERR_ARGS, "Invalid long option");
+    }
+
+    // Short options:
+    if (csArgv.cStr[0] == '-') {
+      for (iChar = 1; iChar < csArgv.len; ++iChar) {
+        cOpt = csArgv.cStr[iChar];
+        if (cOpt == 'h') {
+          usage(ERR_NOERR, "");
+        }
+        if (cOpt == 'v') {
+          version();
+        }
+        if (cOpt == 'e') {
+          g_tOpts.iEncode = 1;
+          continue;
+        }
+        if (cOpt == 'p') {
+          if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "Parity is missing");
+          if      (!strcmp(csRv.cStr, "even")) g_tOpts.iOdd = 0;
+          else if (!strcmp(csRv.cStr, "odd"))  g_tOpts.iOdd = 1;
+          else dispatchError(ERR_ARGS, "Parity is neither 'even' nor 'odd'");
+          continue;
+        }
+        if (cOpt == 'b') {
+          if (! getArgInt(&g_tOpts.iBits, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid bit count or missing");
+          continue;
+        }
+        dispatchError(ERR_ARGS, "Invalid short option");
+      }
+      goto next_argument;
+    }
+    // Else, it's just a filename.
+    daAdd(cstr, g_tArgs, csNew(csArgv.cStr));
   }
-  // 0: even; !0: odd
-  return iParity;
+
+  // Sanity check of arguments and flags.
+  if (g_tOpts.iBits < BITS_MIN || g_tOpts.iBits > BITS_MAX)
+    dispatchError(ERR_ARGS, "Bit count not within 5 ... 7");
+  if ((g_tOpts.csRejects.len != 0 || g_tOpts.iStats) && g_tOpts.iEncode)
+    dispatchError(ERR_ARGS, "'--rejects' and '--stats' don't work with '-e'");
+  if (g_tOpts.csRejects.len != 0 && g_tArgs.sCount > 1)
+    dispatchError(ERR_ARGS, "'--rejects' takes at most one file");
+
+  // Switch to stdin if no files were given.
+  if (g_tArgs.sCount == 0) g_tOpts.iReadStdin = 1;
+
+  // Free string memory.
+  csFree(&csArgv);
+  csFree(&csRv);
 }
 
+
+//******************************************************************************
+//*** filter
+
+/*******************************************************************************
+ * Name:  filterScalar
+ * Purpose: Every byte is stored, but the position only advances for good
+ *          ones. So there is no branch, which mispredicts on random parity.
+ *******************************************************************************/
+size_t filterScalar(uchar* pucDst, const uchar* pucSrc, size_t sLen, int iOdd, uchar* pucMask) {
+  size_t sCount = 0;
+
+  if (! pucMask) {
+    for (size_t i = 0; i < sLen; ++i) {
+      pucDst[sCount] = pucSrc[i];
+      sCount += __builtin_parity(pucSrc[i]) == iOdd;
+    }
+    return sCount;
+  }
+
+  memset(pucMask, 0, (sLen + 7) / 8);
+  for (size_t i = 0; i < sLen; ++i) {
+    int iGood = __builtin_parity(pucSrc[i]) == iOdd;
+
+    pucDst[sCount]   = pucSrc[i];
+    sCount          += iGood;
+    pucMask[i >> 3] |= (uchar) (! iGood << (i & 7));
+  }
+
+  return sCount;
+}
+
+#ifdef PO_X86
+
+// Shuffle indices of the set bits of every 8 bit mask, packed to the front.
+uint64_t g_aui64Compact[256];
+
+/*******************************************************************************
+ * Name:  initCompact
+ * Purpose: Builds the shuffle table used to compact 8 bytes by their mask.
+ *******************************************************************************/
+void initCompact(void) {
+  for (int m = 0; m < 256; ++m) {
+    uint64_t ui64Idx = 0;
+    int      iPos    = 0;
+
+    for (int b = 0; b < 8; ++b)
+      if (m & (1 << b)) ui64Idx |= (uint64_t) b << (8 * iPos++);
+    g_aui64Compact[m] = ui64Idx;
+  }
+}
+
+/*******************************************************************************
+ * Name:  compact16
+ * Purpose: Stores the bytes of a 16 byte lane, whose mask bit is set, and
+ *          returns the count stored. Every 8 bytes are shuffled to the front
+ *          by the table and stored in full, the next store overwrites the
+ *          rest.
+ *******************************************************************************/
+__attribute__((target("avx2,popcnt")))
+static inline size_t compact16(uchar* pucDst, __m128i xLane, uint32_t ui32Mask) {
+  const __m128i xHigh = _mm_set1_epi8(8);
+  uint32_t      uiLo  = ui32Mask & 0xff;
+  uint32_t      uiHi  = (ui32Mask >> 8) & 0xff;
+  size_t        sLo   = _mm_popcnt_u32(uiLo);
+  __m128i       xIdx  = _mm_cvtsi64_si128((long long) g_aui64Compact[uiLo]);
+
+  _mm_storel_epi64((__m128i*) pucDst, _mm_shuffle_epi8(xLane, xIdx));
+  xIdx = _mm_add_epi8(_mm_cvtsi64_si128((long long) g_aui64Compact[uiHi]), xHigh);
+  _mm_storel_epi64((__m128i*) (pucDst + sLo), _mm_shuffle_epi8(xLane, xIdx));
+
+  return sLo + _mm_popcnt_u32(uiHi);
+}
+
+/*******************************************************************************
+ * Name:  filterAvx2
+ * Purpose: Parity of 32 bytes is the xor of their nibbles' parities, looked
+ *          up with pshufb. The movemask of good bytes drives compact16().
+ *******************************************************************************/
+__attribute__((target("avx2,popcnt")))
+size_t filterAvx2(uchar* pucDst, const uchar* pucSrc, size_t sLen, int iOdd, uchar* pucMask) {
+  const __m256i yLow    = _mm256_set1_epi8(0x0f);
+  const __m256i yParity = _mm256_setr_epi8(0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0,
+                                           0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0);
+  const __m256i yKeep   = _mm256_set1_epi8((char) iOdd);
+  size_t        sCount  = 0;
+  size_t        i       = 0;
+
+  for (i = 0; i + 32 <= sLen; i += 32) {
+    __m256i  yIn   = _mm256_loadu_si256((const __m256i*) (pucSrc + i));
+    __m256i  yLo   = _mm256_shuffle_epi8(yParity, _mm256_and_si256(yIn, yLow));
+    __m256i  yHi   = _mm256_shuffle_epi8(yParity, _mm256_and_si256(_mm256_srli_epi16(yIn, 4), yLow));
+    __m256i  yGood = _mm256_cmpeq_epi8(_mm256_xor_si256(yLo, yHi), yKeep);
+    uint32_t uiMask = (uint32_t) _mm256_movemask_epi8(yGood);
+
+    if (pucMask) {
+      uint32_t uiDrop = ~uiMask;
+      memcpy(pucMask + i / 8, &uiDrop, 4);
+    }
+
+    sCount += compact16(pucDst + sCount, _mm256_castsi256_si128(yIn),      uiMask & 0xffff);
+    sCount += compact16(pucDst + sCount, _mm256_extracti128_si256(yIn, 1), uiMask >> 16);
+  }
+
+  return sCount + filterScalar(pucDst + sCount, pucSrc + i, sLen - i, iOdd,
+                               pucMask ? pucMask + i / 8 : NULL);
+}
+
+/*******************************************************************************
+ * Name:  filterAvx512
+ * Purpose: Counts bits of 64 bytes with vpopcntb, good bytes are compacted
+ *          with vpcompressb and stored in full.
+ *******************************************************************************/
+__attribute__((target("avx512f,avx512bw,avx512bitalg,avx512vbmi2,popcnt")))
+size_t filterAvx512(uchar* pucDst, const uchar* pucSrc, size_t sLen, int iOdd, uchar* pucMask) {
+  const __m512i zOne   = _mm512_set1_epi8(1);
+  const __m512i zKeep  = _mm512_set1_epi8((char) iOdd);
+  size_t        sCount = 0;
+  size_t        i      = 0;
+
+  for (i = 0; i + 64 <= sLen; i += 64) {
+    __m512i   zIn   = _mm512_loadu_si512((const void*) (pucSrc + i));
+    __mmask64 kGood = _mm512_cmpeq_epi8_mask(_mm512_and_si512(_mm512_popcnt_epi8(zIn), zOne), zKeep);
+
+    if (pucMask) {
+      uint64_t ui64Drop = ~kGood;
+      memcpy(pucMask + i / 8, &ui64Drop, 8);
+    }
+
+    _mm512_storeu_si512((void*) (pucDst + sCount), _mm512_maskz_compress_epi8(kGood, zIn));
+    sCount += _mm_popcnt_u64(kGood);
+  }
+
+  return sCount + filterScalar(pucDst + sCount, pucSrc + i, sLen - i, iOdd,
+                               pucMask ? pucMask + i / 8 : NULL);
+}
+
+/*******************************************************************************
+ * Name:  hasAvx2
+ * Purpose: Checks via cpuid, if AVX2 kernel can run on this host.
+ *******************************************************************************/
+int hasAvx2(void) {
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+/*******************************************************************************
+ * Name:  hasAvx512
+ * Purpose: Checks via cpuid, if AVX-512 kernel with vpopcntb can run.
+ *******************************************************************************/
+int hasAvx512(void) {
+  return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512bitalg") &&
+         __builtin_cpu_supports("avx512vbmi2");
+}
+
+#endif // PO_X86
+
 /*******************************************************************************
- *
+ * Name:  hasScalar
+ * Purpose: Scalar kernel runs everywhere.
  *******************************************************************************/
-void printBytes(uchar* paucByte, int c) {
-  t_bb tBb = {0};
+int hasScalar(void) {
+  return 1;
+}
 
-  // 8 * 7 bits = 56 bites = 7 Bytes
-  // 111 1111  111 1111  111 1111  111 1111  111 1111 111 1111 111 1111 111 1111
-  // 1111 1111  1111 1111  1111 1111  1111 1111  1111 1111  1111 1111  1111 1111
+// All kernels, the last one supported by the host is used.
+t_filter g_atFilters[] = {
+  {"scalar", hasScalar, filterScalar},
+#ifdef PO_X86
+  {"avx2",   hasAvx2,   filterAvx2},
+  {"avx512", hasAvx512, filterAvx512},
+#endif
+};
 
-  // Compress 8 to 7 bytes.
-  for (int i = 0; i < 8; ++i) tBb.i64Int = (tBb.i64Int << 7) | (paucByte[i] >> 1);
+// Kernel in use.
+t_filter* g_ptFilter = &g_atFilters[0];
 
-  // Print all bytes (watch for little endianess!).
-  for (int i = 0; i < 7; ++i) putchar(tBb.aBytes[6 - i]);
+/*******************************************************************************
+ * Name:  selectFilter
+ * Purpose: Selects the newest kernel supported by this host.
+ *******************************************************************************/
+void selectFilter(void) {
+#ifdef PO_X86
+  initCompact();
+#endif
+  for (size_t i = 0; i < arraySize(g_atFilters); ++i)
+    if (g_atFilters[i].isSupported()) g_ptFilter = &g_atFilters[i];
 }
 
+//*** filter
+//******************************************************************************
+
 
 //******************************************************************************
-int main() {
-  uchar aucByte[8] = {0};
-  int   iCount     =  0;
-  int   c          =  0;
+//*** pack
 
-  while ((c = getchar()) != EOF) {
-    // That's odd parity plus the parity bit itself.
-    if (getParity(c) != PARITY_EVEN) continue;
+/*******************************************************************************
+ * Name:  addParity
+ * Purpose: Sets the parity bit of all 8 bytes, which must be clear. Each
+ *          byte folds onto its own low bits only. Constant iMsb and iOdd
+ *          fold away in the generated packers.
+ *******************************************************************************/
+static inline uint64_t addParity(uint64_t ui64Bytes, int iMsb, int iOdd) {
+  uint64_t ui64P = ui64Bytes ^ (ui64Bytes >> 4);
 
-    // Store the byte for further processing and count stored bytes.
-    aucByte[iCount++] = c;
+  ui64P ^= ui64P >> 2;
+  ui64P ^= ui64P >> 1;
+  ui64P  = (ui64P ^ (iOdd ? 0x0101010101010101ULL : 0)) & 0x0101010101010101ULL;
 
-    // Store full? Print all bits/bytes.
-    if (iCount == 8) {
-      printBytes(aucByte, c);
-      iCount = 0;
+  return ui64Bytes | (iMsb ? ui64P << 7 : ui64P);
+}
+
+/*******************************************************************************
+ * Name:  DEFINE_PACKER_SCALAR
+ * Purpose: Defines pack and encode functions for one layout. Pack takes the
+ *          data bits of 8 bytes into BITS bytes, big endian. Encode spreads
+ *          BITS bytes onto 8 bytes and adds the parity bit. Both return count
+ *          of bytes written.
+ *******************************************************************************/
+#define DEFINE_PACKER_SCALAR(ID, BITS, MSB, ODD)                               \
+size_t packScalar##ID(uchar* pucDst, const uchar* pucSrc, size_t sGroups) {    \
+  for (size_t g = 0; g < sGroups; ++g) {                                       \
+    uint64_t ui64Bits = 0;                                                     \
+                                                                               \
+    for (int i = 0; i < GROUP_IN; ++i)                                         \
+      ui64Bits = (ui64Bits << (BITS)) |                                        \
+                 ((pucSrc[g * GROUP_IN + i] >> !(MSB)) & ((1 << (BITS)) - 1)); \
+    for (int i = 0; i < (BITS); ++i)                                           \
+      pucDst[g * (BITS) + i] = (uchar) (ui64Bits >> (8 * ((BITS) - 1 - i)));   \
+  }                                                                            \
+                                                                               \
+  return sGroups * (BITS);                                                     \
+}                                                                              \
+                                                                               \
+size_t encodeScalar##ID(uchar* pucDst, const uchar* pucSrc, size_t sGroups) {  \
+  for (size_t g = 0; g < sGroups; ++g) {                                       \
+    uint64_t ui64Bits  = 0;                                                    \
+    uint64_t ui64Bytes = 0;                                                    \
+                                                                               \
+    for (int i = 0; i < (BITS); ++i)                                           \
+      ui64Bits = (ui64Bits << 8) | pucSrc[g * (BITS) + i];                     \
+    for (int i = 0; i < GROUP_IN; ++i)                                         \
+      ui64Bytes |= ((ui64Bits >> ((BITS) * (GROUP_IN - 1 - i))) &              \
+                    ((1 << (BITS)) - 1)) << (8 * i + !(MSB));                  \
+                                                                               \
+    ui64Bytes = addParity(ui64Bytes, MSB, ODD);                                \
+    for (int i = 0; i < GROUP_IN; ++i)                                         \
+      pucDst[g * GROUP_IN + i] = (uchar) (ui64Bytes >> (8 * i));               \
+  }                                                                            \
+                                                                               \
+  return sGroups * GROUP_IN;                                                   \
+}
+
+#ifdef PO_X86
+
+/*******************************************************************************
+ * Name:  DEFINE_PACKER_BMI2
+ * Purpose: Defines pack and encode functions for one layout with BMI2. Byte
+ *          swapped, the data bits of 8 bytes are extracted by one pext in
+ *          stream order, encode is the inverse pdep. Every group reads and
+ *          writes 8 bytes, the last ones are left to the scalar functions,
+ *          not to touch bytes behind the end.
+ *******************************************************************************/
+#define DEFINE_PACKER_BMI2(ID, BITS, MSB, ODD)                                 \
+__attribute__((target("bmi2")))                                                \
+size_t packBmi2##ID(uchar* pucDst, const uchar* pucSrc, size_t sGroups) {      \
+  size_t g = 0;                                                                \
+                                                                               \
+  for (g = 0; (g + 1) * (BITS) + 8 <= sGroups * (BITS); ++g) {                 \
+    uint64_t ui64In = 0;                                                       \
+                                                                               \
+    memcpy(&ui64In, pucSrc + g * GROUP_IN, 8);                                 \
+    ui64In = _pext_u64(__builtin_bswap64(ui64In), DATA_MASK(BITS, !(MSB)));    \
+    ui64In = __builtin_bswap64(ui64In << (64 - 8 * (BITS)));                   \
+    memcpy(pucDst + g * (BITS), &ui64In, 8);                                   \
+  }                                                                            \
+  packScalar##ID(pucDst + g * (BITS), pucSrc + g * GROUP_IN, sGroups - g);     \
+                                                                               \
+  return sGroups * (BITS);                                                     \
+}                                                                              \
+                                                                               \
+__attribute__((target("bmi2")))                                                \
+size_t encodeBmi2##ID(uchar* pucDst, const uchar* pucSrc, size_t sGroups) {    \
+  size_t g = 0;                                                                \
+                                                                               \
+  for (g = 0; g * (BITS) + 8 <= sGroups * (BITS); ++g) {                       \
+    uint64_t ui64In = 0;                                                       \
+                                                                               \
+    memcpy(&ui64In, pucSrc + g * (BITS), 8);                                   \
+    ui64In = __builtin_bswap64(ui64In) >> (64 - 8 * (BITS));                   \
+    ui64In = _pdep_u64(ui64In, DATA_MASK(BITS, !(MSB)));                       \
+    ui64In = addParity(__builtin_bswap64(ui64In), MSB, ODD);                   \
+    memcpy(pucDst + g * GROUP_IN, &ui64In, 8);                                 \
+  }                                                                            \
+  encodeScalar##ID(pucDst + g * GROUP_IN, pucSrc + g * (BITS), sGroups - g);   \
+                                                                               \
+  return sGroups * GROUP_IN;                                                   \
+}
+
+/*******************************************************************************
+ * Name:  hasBmi2
+ * Purpose: Checks via cpuid, if BMI2 kernel can run on this host.
+ *******************************************************************************/
+int hasBmi2(void) {
+  return __builtin_cpu_supports("bmi2");
+}
+
+// Layout with scalar and BMI2 packers.
+#define LAYOUT(ID, BITS, MSB, ODD)                                              \
+  {BITS, MSB, ODD, {{"scalar", hasScalar, packScalar##ID, encodeScalar##ID},   \
+                    {"bmi2",   hasBmi2,   packBmi2##ID,   encodeBmi2##ID}}}
+
+#else
+
+#define DEFINE_PACKER_BMI2(ID, BITS, MSB, ODD)
+
+// Layout with scalar packers only.
+#define LAYOUT(ID, BITS, MSB, ODD)                                              \
+  {BITS, MSB, ODD, {{"scalar", hasScalar, packScalar##ID, encodeScalar##ID}}}
+
+#endif // PO_X86
+
+// All packers of a layout.
+#define DEFINE_PACKERS(ID, BITS, MSB, ODD) \
+  DEFINE_PACKER_SCALAR(ID, BITS, MSB, ODD) \
+  DEFINE_PACKER_BMI2(ID, BITS, MSB, ODD)
+
+// Layouts: data bits, parity bit 0 or 7, even or odd parity.
+DEFINE_PACKERS(7le, 7, 0, 0)
+DEFINE_PACKERS(7lo, 7, 0, 1)
+DEFINE_PACKERS(7me, 7, 1, 0)
+DEFINE_PACKERS(7mo, 7, 1, 1)
+DEFINE_PACKERS(6le, 6, 0, 0)
+DEFINE_PACKERS(6lo, 6, 0, 1)
+DEFINE_PACKERS(6me, 6, 1, 0)
+DEFINE_PACKERS(6mo, 6, 1, 1)
+DEFINE_PACKERS(5le, 5, 0, 0)
+DEFINE_PACKERS(5lo, 5, 0, 1)
+DEFINE_PACKERS(5me, 5, 1, 0)
+DEFINE_PACKERS(5mo, 5, 1, 1)
+
+t_layout g_atLayouts[] = {
+  LAYOUT(7le, 7, 0, 0), LAYOUT(7lo, 7, 0, 1), LAYOUT(7me, 7, 1, 0), LAYOUT(7mo, 7, 1, 1),
+  LAYOUT(6le, 6, 0, 0), LAYOUT(6lo, 6, 0, 1), LAYOUT(6me, 6, 1, 0), LAYOUT(6mo, 6, 1, 1),
+  LAYOUT(5le, 5, 0, 0), LAYOUT(5lo, 5, 0, 1), LAYOUT(5me, 5, 1, 0), LAYOUT(5mo, 5, 1, 1),
+};
+
+// Layout and its kernel in use.
+t_layout* g_ptLayout = &g_atLayouts[0];
+t_packer* g_ptPacker = &g_atLayouts[0].atPackers[0];
+
+/*******************************************************************************
+ * Name:  selectPacker
+ * Purpose: Selects the layout given by cli and its newest kernel supported by
+ *          this host.
+ *******************************************************************************/
+void selectPacker(void) {
+  for (size_t i = 0; i < arraySize(g_atLayouts); ++i)
+    if (g_atLayouts[i].iBits == g_tOpts.iBits && g_atLayouts[i].iMsb == g_tOpts.iMsb &&
+        g_atLayouts[i].iOdd  == g_tOpts.iOdd)
+      g_ptLayout = &g_atLayouts[i];
+
+  g_ptPacker = &g_ptLayout->atPackers[0];
+  for (size_t i = 0; i < arraySize(g_ptLayout->atPackers); ++i)
+    if (g_ptLayout->atPackers[i].isSupported()) g_ptPacker = &g_ptLayout->atPackers[i];
+}
+
+//*** pack
+//******************************************************************************
+
+
+//******************************************************************************
+//*** io
+
+/*******************************************************************************
+ * Name:  writeBlock
+ * Purpose: Writes all bytes, even if the pipe takes only a part at once.
+ *******************************************************************************/
+void writeBlock(int iFd, const uchar* pucBuf, size_t sLen) {
+  ssize_t sWritten = 0;
+
+  while (sLen > 0) {
+    if ((sWritten = write(iFd, pucBuf, sLen)) < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error writing output");
+    }
+    pucBuf += sWritten;
+    sLen   -= sWritten;
+  }
+}
+
+/*******************************************************************************
+ * Name:  readBlock
+ * Purpose: Reads what the stream has, or, if iFull is set, until the buffer
+ *          is full or at EOF. Returns count read.
+ *******************************************************************************/
+size_t readBlock(int iFd, uchar* pucBuf, size_t sMax, int iFull) {
+  size_t  sLen  = 0;
+  ssize_t sRead = 0;
+
+  while (sLen < sMax && (sRead = read(iFd, pucBuf + sLen, sMax - sLen)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    sLen += sRead;
+    if (! iFull) break;
+  }
+
+  return sLen;
+}
+
+/*******************************************************************************
+ * Name:  processFile
+ * Purpose: Filters a stream block by block and packs all full groups. Good
+ *          bytes of an incomplete group are carried over to the next block.
+ *          With a bitmap file or stats every block is a full MiB, so the
+ *          bitmap of each block starts at a byte and counts are per MiB.
+ *******************************************************************************/
+void processFile(int iFdIn, int iFdOut, int iFdMask, t_stats* ptStats) {
+  int     iFull   = iFdMask >= 0 || ptStats;
+  uchar*  pucIn   = (uchar*) malloc(BUF_SIZE);
+  uchar*  pucGood = (uchar*) malloc(GROUP_IN + BUF_SIZE + BUF_SLACK);
+  uchar*  pucOut  = (uchar*) malloc(BUF_SIZE);
+  uchar*  pucMask = iFdMask >= 0 ? (uchar*) malloc(BUF_SIZE / 8) : NULL;
+  size_t  sKept   = 0;
+  size_t  sGood   = 0;
+  size_t  sGroups = 0;
+  size_t  sRead   = 0;
+
+  if (! pucIn || ! pucGood || ! pucOut || (iFdMask >= 0 && ! pucMask))
+    dispatchError(ERR_ELSE, "Out of memory");
+
+  while ((sRead = readBlock(iFdIn, pucIn, BUF_SIZE, iFull)) != 0) {
+    sKept   = g_ptFilter->filter(pucGood + sGood, pucIn, sRead, g_tOpts.iOdd, pucMask);
+    sGood  += sKept;
+    sGroups = sGood / GROUP_IN;
+    writeBlock(iFdOut, pucOut, g_ptPacker->pack(pucOut, pucGood, sGroups));
+
+    if (pucMask) writeBlock(iFdMask, pucMask, (sRead + 7) / 8);
+    if (ptStats) {
+      daAdd(size_t, ptStats->tDrops, sRead - sKept);
+      ptStats->sBytes   += sRead;
+      ptStats->sDropped += sRead - sKept;
+    }
+
+    // Move incomplete group to front.
+    memmove(pucGood, pucGood + sGroups * GROUP_IN, sGood - sGroups * GROUP_IN);
+    sGood -= sGroups * GROUP_IN;
+  }
+
+  if (ptStats) ptStats->sLeft = sGood;
+
+  free(pucMask);
+  free(pucOut);
+  free(pucGood);
+  free(pucIn);
+}
+
+/*******************************************************************************
+ * Name:  printStats
+ * Purpose: Prints drops per MiB and what is left over at EOF to stderr.
+ *******************************************************************************/
+void printStats(const char* pcName, t_stats* ptStats) {
+  fprintf(stderr, "%s:\n", pcName);
+  fprintf(stderr, "     MiB     dropped\n");
+  for (size_t i = 0; i < ptStats->tDrops.sCount; ++i)
+    fprintf(stderr, "%8zu  %10zu\n", i, ptStats->tDrops.pVal[i]);
+  fprintf(stderr, "bytes: %zu, dropped: %zu, good: %zu\n", ptStats->sBytes,
+          ptStats->sDropped, ptStats->sBytes - ptStats->sDropped);
+  fprintf(stderr, "left over at EOF: %zu good bytes, %zu data bits not packed\n",
+          ptStats->sLeft, ptStats->sLeft * g_tOpts.iBits);
+}
+
+/*******************************************************************************
+ * Name:  encodeFile
+ * Purpose: Encodes a stream block by block, bytes of an incomplete group are
+ *          carried over. The last group is padded with zeros.
+ *******************************************************************************/
+void encodeFile(int iFdIn, int iFdOut) {
+  int     iBits   = g_tOpts.iBits;
+  uchar*  pucIn   = (uchar*) malloc(BITS_MAX + BUF_SIZE);
+  uchar*  pucOut  = (uchar*) malloc(BUF_SIZE / BITS_MIN * GROUP_IN + 2 * GROUP_IN);
+  size_t  sLen    = 0;
+  size_t  sGroups = 0;
+  ssize_t sRead   = 0;
+
+  if (! pucIn || ! pucOut) dispatchError(ERR_ELSE, "Out of memory");
+
+  while ((sRead = read(iFdIn, pucIn + sLen, BUF_SIZE)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    sLen   += sRead;
+    sGroups = sLen / iBits;
+    writeBlock(iFdOut, pucOut, g_ptPacker->encode(pucOut, pucIn, sGroups));
+
+    // Move incomplete group to front.
+    memmove(pucIn, pucIn + sGroups * iBits, sLen - sGroups * iBits);
+    sLen -= sGroups * iBits;
+  }
+
+  if (sLen > 0) {
+    memset(pucIn + sLen, 0, iBits - sLen);
+    writeBlock(iFdOut, pucOut, g_ptPacker->encode(pucOut, pucIn, 1));
+  }
+
+  free(pucOut);
+  free(pucIn);
+}
+
+//*** io
+//******************************************************************************
+
+
+//******************************************************************************
+//*** benchmark
+
+/*******************************************************************************
+ * Name:  getSeconds
+ * Purpose: Returns monotonic time in seconds.
+ *******************************************************************************/
+double getSeconds(void) {
+  struct timespec tTs = {0};
+  clock_gettime(CLOCK_MONOTONIC, &tTs);
+  return tTs.tv_sec + tTs.tv_nsec / 1e9;
+}
+
+/*******************************************************************************
+ * Name:  createBenchData
+ * Purpose: Creates random bytes, so about half of them have odd parity.
+ *******************************************************************************/
+uchar* createBenchData(void) {
+  uchar*   pucData = (uchar*) malloc(BENCH_SIZE);
+  uint32_t u32Rnd  = 0x12345678;
+
+  if (! pucData) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (size_t i = 0; i < BENCH_SIZE; i += 4) {
+    // Simple xorshift, good enough for test data.
+    u32Rnd ^= u32Rnd << 13;
+    u32Rnd ^= u32Rnd >> 17;
+    u32Rnd ^= u32Rnd <<  5;
+    memcpy(pucData + i, &u32Rnd, 4);
+  }
+
+  return pucData;
+}
+
+/*******************************************************************************
+ * Name:  benchmark
+ * Purpose: Prints throughput of all kernels supported by this host, each the
+ *          best of three runs over the whole test data.
+ *******************************************************************************/
+void benchmark(void) {
+  uchar* pucData = createBenchData();
+  uchar* pucOut  = (uchar*) malloc(BENCH_SIZE / BITS_MIN * GROUP_IN + 2 * GROUP_IN + BUF_SLACK);
+  size_t sGood   = 0;
+
+  if (! pucOut) dispatchError(ERR_ELSE, "Out of memory");
+
+  printf("filter   filter MB/s\n");
+  for (size_t i = 0; i < arraySize(g_atFilters); ++i) {
+    double dBest = 0.0;
+
+    if (! g_atFilters[i].isSupported()) continue;
+    for (int r = 0; r < 3; ++r) {
+      double dTime = getSeconds();
+      sGood = g_atFilters[i].filter(pucOut, pucData, BENCH_SIZE, g_tOpts.iOdd, NULL);
+      dTime = getSeconds() - dTime;
+      if (r == 0 || dTime < dBest) dBest = dTime;
+    }
+    printf("%-8s %11.1f\n", g_atFilters[i].pcName, BENCH_SIZE / dBest / 1e6);
+  }
+
+  printf("packer     pack MB/s  encode MB/s\n");
+  for (size_t i = 0; i < arraySize(g_ptLayout->atPackers); ++i) {
+    t_packer* ptPacker = &g_ptLayout->atPackers[i];
+    double dPack   = 0.0;
+    double dEncode = 0.0;
+
+    if (! ptPacker->isSupported()) continue;
+    for (int r = 0; r < 3; ++r) {
+      double dTime = getSeconds();
+      ptPacker->pack(pucOut, pucData, BENCH_SIZE / GROUP_IN);
+      dTime = getSeconds() - dTime;
+      if (r == 0 || dTime < dPack) dPack = dTime;
+
+      dTime = getSeconds();
+      ptPacker->encode(pucOut, pucData, BENCH_SIZE / g_ptLayout->iBits);
+      dTime = getSeconds() - dTime;
+      if (r == 0 || dTime < dEncode) dEncode = dTime;
+    }
+    printf("%-8s %11.1f  %11.1f\n", ptPacker->pcName,
+           BENCH_SIZE / dPack / 1e6, BENCH_SIZE / dEncode / 1e6);
+  }
+
+  // Keep filter runs from being optimized away.
+  if (sGood == 0) printf("No good bytes\n");
+
+  free(pucOut);
+  free(pucData);
+}
+
+//*** benchmark
+//******************************************************************************
+
+
+//******************************************************************************
+//* main
+
+int main(int argc, char *argv[]) {
+  FILE*    hFile    = NULL;
+  FILE*    hRejects = NULL;
+  t_stats  tStats   = {0};
+  t_stats* ptStats  = NULL;
+  int      iStdin   = 0;
+
+  // Save program's name.
+  g_csMename = csNew("");
+  getMename(&g_csMename, argv[0]);
+
+  // Get options and dispatch errors, if any.
+  getOptions(argc, argv);
+
+  // Use the fastest kernels of this host.
+  selectFilter();
+  selectPacker();
+
+  // Only measure speed of kernels.
+  if (g_tOpts.iBench) {
+    benchmark();
+    return ERR_NOERR;
+  }
+
+  // Open bitmap sidecar and stats, if wanted.
+  if (g_tOpts.csRejects.len != 0) hRejects = openFile(g_tOpts.csRejects.cStr, "wb");
+  if (g_tOpts.iStats) ptStats = &tStats;
+
+  // If to use stdin instead of files, say so.
+  iStdin = g_tOpts.iReadStdin;
+
+  // Get all data from all files, or stdin.
+  for (int i = 0; i < g_tArgs.sCount || iStdin; ++i) {
+    if (iStdin) {
+      hFile  = stdin;
+      iStdin = 0;
+    }
+    else {
+      hFile = openFile(g_tArgs.pVal[i].cStr, "rb");
+    }
+//-- file ----------------------------------------------------------------------
+    if (g_tOpts.iEncode) {
+      encodeFile(fileno(hFile), STDOUT_FILENO);
     }
+    else {
+      if (ptStats) daInit(size_t, tStats.tDrops);
+      processFile(fileno(hFile), STDOUT_FILENO, hRejects ? fileno(hRejects) : -1, ptStats);
+      if (ptStats) {
+        printStats(hFile == stdin ? "stdin" : g_tArgs.pVal[i].cStr, ptStats);
+        daFree(tStats.tDrops);
+        memset(&tStats, 0, sizeof(tStats));
+      }
+    }
+//-- file ----------------------------------------------------------------------
+    fclose(hFile);
   }
+
+  if (hRejects) fclose(hRejects);
+
+  // Free all used memory, prior end of program.
+  daFreeEx(g_tArgs, cStr);
+  csFree(&g_tOpts.csRejects);
+
+  return ERR_NOERR;
 }
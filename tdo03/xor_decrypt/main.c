@@ -1,72 +1,1656 @@
+/*******************************************************************************
+ ** Name: xor_decrypt
+ ** Purpose: Decrypts data xored with a repeating key, or recovers that key.
+ ** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+ *******************************************************************************
+ ** Date        User  Log
+ **-----------------------------------------------------------------------------
+ ** 17.10.2026  JE    Changed it with the standard program skeleton.
+ ** 17.10.2026  JE    Added '--recover' to find the key by letter frequencies
+ **                   per key position and by known plaintext given with '-c'.
+ ** 17.10.2026  JE    Added '--guess-keylen' to rank key lengths by hamming
+ **                   distance and index of coincidence.
+ ** 17.10.2026  JE    Added '-k' and '--key-file' to set the key. Xors with
+ **                   the key repeated into SIMD registers, mapped files are
+ **                   read without copying them first.
+ ** 17.10.2026  JE    Added '--drag' to slide cribs over the data in parallel
+ **                   and '--cribs' to read them from a file.
+ ** 17.10.2026  JE    '--drag' only counts votes of other cribs, prints '??' for
+ **                   key bytes without a clear lead.
+ ** 17.10.2026  JE    '--drag' weighs key bytes against the strongest other one
+ **                   only, so scattered false placements don't outvote cribs.
+ *******************************************************************************/
+
+
+//******************************************************************************
+//* includes & namespaces
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XD_X86                // SIMD kernels, selected at runtime via cpuid.
+#include <immintrin.h>
+#endif
+
+#include "c_string.h"
+#include "c_dynamic_arrays_macros.h"
+
+
+//******************************************************************************
+//* me and myself
+
+#define ME_VERSION "0.5.2"
+cstr g_csMename;
+
+
+//******************************************************************************
+//* defines & macros
+
+#define ERR_NOERR 0x00
+#define ERR_ARGS  0x01
+#define ERR_FILE  0x02
+#define ERR_ELSE  0xff
+
+#define sERR_ARGS  "Argument error"
+#define sERR_FILE  "File error"
+#define sERR_ELSE  "Unknown error"
+
+// Bytes read at once.
+#define BUF_SIZE (1024 * 1024)
+
+// Longest key to decrypt with or to recover.
+#define KEY_MAX 256
+
+// Widest vector register, the key pattern is a multiple of it.
+#define VEC_MAX 64
+
+// Index of coincidence is taken from this many bytes at most.
+#define IOC_SAMPLE (1024 * 1024)
+
+// Key lengths within this part of the best hamming distance count as equal.
+#define HAM_EQUAL 0.02
+
+// Dragged cribs must decrypt every key position to at least this much text,
+// scoring at least this part of the position's best English score.
+#define DRAG_TEXT 0.95
+#define DRAG_FIT  0.5f
+
+// Dragged key bytes lead clearly with this many times the runner-up's votes.
+#define DRAG_LEAD 2.0
+
+// Dragged key bytes of a single crib need a placement with this vote at least.
+// Placements of a crib found often may be real text only, where others agree.
+#define DRAG_ALONE 0.5
+
+// Votes closer to 0.0 than this are 0.0, sums of fractions don't cancel out.
+#define DRAG_EPS 1e-9
+
+// Dragged cribs need this many key bytes, other cribs agree on. Each counts
+// by its share of their votes, so chance hits among scattered ones count less.
+#define DRAG_AGREE 2.0
+
+// Key byte was found by ...
+#define FROM_FREQ 0x00
+#define FROM_CRIB 0x01
+
+
+//******************************************************************************
+//* outsourced standard functions, includes and defines
+
+#include "stdfcns.c"
+
+
+//******************************************************************************
+//* typedefs
+
+// Known plaintext at an offset.
+typedef struct s_crib {
+  uchar* pucText;
+  size_t sLen;
+  size_t sOff;
+} t_crib;
+
+s_array(cstr);
+s_array(t_crib);
+
+// Arguments and options.
+typedef struct s_options {
+  t_array(t_crib) tCribs;
+  int             iRecover;
+  int             iGuessMax;
+  int             iDrag;
+  int             iKeyLen;
+  int             iKeySet;     // Count of '-k' and '--key-file'.
+  uchar           aucKey[KEY_MAX];
+  size_t          sKeyLen;
+  int             iThreads;
+  int             iReadStdin;
+} t_options;
+
+// Key repeated to lcm(key length, VEC_MAX) bytes and VEC_MAX bytes more, so
+// a vector load at any phase stays inside.
+typedef struct s_pattern {
+  uchar* pucPat;
+  size_t sLen;     // Period of the pattern.
+  size_t sKeyLen;
+} t_pattern;
+
+// Xors source with the pattern from phase on into destination, both may be
+// the same.
+typedef struct s_kernel {
+  const char* pcName;
+  int  (*isSupported)(void);
+  void (*xorKey)(uchar* pucDst, const uchar* pucSrc, size_t sLen, const t_pattern* ptPat,
+                 size_t sPhase);
+} t_kernel;
+
+// Recovered key byte.
+typedef struct s_keybyte {
+  uchar  ucKey;
+  double dConf;   // 0.0 ... 1.0
+  int    iFrom;
+  int    iConflicts;
+} t_keybyte;
+
+// Part of the recovery done by one thread.
+typedef struct s_part {
+  const uchar* pucData;
+  size_t       sBeg;
+  size_t       sEnd;
+  int          iKeyLen;
+  uint32_t*    pui32Hist;  // Histogram of every key position.
+  int          iFirst;     // Key positions iFirst, iFirst + iStep, ...
+  int          iStep;
+  t_keybyte*   ptKey;
+} t_part;
+
+// Scores of a key length.
+typedef struct s_keylen {
+  int    iLen;
+  double dHamming;  // Differing bits per bit of bytes iLen apart.
+  double dIoc;      // Mean index of coincidence of all key positions.
+} t_keylen;
+
+// Key lengths guessed by one thread.
+typedef struct s_guess {
+  const uchar* pucData;
+  size_t       sLen;
+  int          iFirst;     // Key lengths iFirst, iFirst + iStep, ...
+  int          iStep;
+  int          iMax;
+  t_keylen*    ptLens;
+} t_guess;
+
+// Crib at an offset, which decrypts its key positions to text.
+typedef struct s_place {
+  size_t sOff;
+  int    iCrib;
+} t_place;
 
-int g_iKeyLen = 32;
-int g_aiKey[] = {
+s_array(t_place);
+
+// Offsets, cribs are dragged over by one thread.
+typedef struct s_drag {
+  const uchar*     pucData;
+  size_t           sLen;
+  size_t           sBeg;
+  size_t           sEnd;
+  int              iKeyLen;
+  const float*     pfFit;     // Fit of every key position and key byte.
+  t_array(t_place) tPlaces;
+} t_drag;
+
+
+//******************************************************************************
+//* Global variables
+
+// Arguments
+t_options     g_tOpts;  // CLI options and arguments.
+t_array(cstr) g_tArgs;  // Free arguments.
+
+// Key of layer 4, used if no other is given.
+uchar g_aucKey[] = {
   0x6c, 0x24, 0x84, 0x8e, 0x42, 0x19, 0xa8, 0xe1,
   0xc5, 0xdb, 0x57, 0x65, 0xb9, 0xc6, 0x14, 0x9e,
   0xa5, 0x19, 0x35, 0x96, 0x3b, 0x39, 0x7f, 0xa5,
   0x65, 0xd1, 0xfe, 0x01, 0x85, 0x7d, 0xd9, 0x4c
 };
 
+// Plain text weight of every byte value, see initWeights().
+double g_adWeight[256];
+
+
+//******************************************************************************
+//* Functions
+
+/*******************************************************************************
+ * Name:  usage
+ * Purpose: Print help text and exit program.
+ *******************************************************************************/
+void usage(int iErr, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+
+  // Print at least one newline with message.
+  if (csMsg.len != 0)
+    csCat(&csMsg, csMsg.cStr, "\n\n");
+
+  csSetf(&csMsg, "%s"
+//|************************ 80 chars width ****************************************|
+  "usage: %s [-k hex|--key-file file] [file1 file2 ...]\n"
+  "       %s --recover [-l n] [-c text[@offset] ...] [-j n] [file]\n"
+  "       %s --guess-keylen max [-j n] [file]\n"
+  "       %s --drag [-l n] [-c text ...] [--cribs file] [-j n] [file]\n"
+  "       %s [-h|--help|-v|--version]\n"
+  " Decrypts file(s) xored with a repeating key, by default the one of layer 4,\n"
+  " and prints them to stdout. Data can also been piped into the program.\n"
+  "  -k hex:        key as hex digits, two per byte, 1 ... 256 bytes\n"
+  "  --key-file file: key as raw bytes of a file, 1 ... 256 bytes\n"
+  "  --recover:     print the key, which makes the data look most like English\n"
+  "                 text, with a confidence of 0.0 ... 1.0 per key byte\n"
+  "  -l n:          key length to recover, 1 ... 256 (default 32)\n"
+  "  --guess-keylen max: rank key lengths 1 ... max by hamming distance of bytes\n"
+  "                 a key length apart and by index of coincidence per key\n"
+  "                 position, both are lowest or highest for the key length\n"
+  "  -c text[@offset]: known plaintext at offset (default 0), fixes key bytes,\n"
+  "                 '\\n', '\\t', '\\\\' and '\\xHH' are unescaped\n"
+  "  --drag:        slide cribs over the data at every offset, keep those, which\n"
+  "                 decrypt their key positions to text and agree with other cribs,\n"
+  "                 print the partial key of length '-l', offsets are ignored\n"
+  "  --cribs file:  add a crib per line of file, like '-c'\n"
+  "  -j n:          threads (default online cpus)\n"
+  "  -h|--help:     print this help\n"
+  "  -v|--version:  print version of program\n"
+//|************************ 80 chars width ****************************************|
+         ,csMsg.cStr,
+         g_csMename.cStr, g_csMename.cStr, g_csMename.cStr, g_csMename.cStr,
+         g_csMename.cStr
+        );
+
+  if (iErr == ERR_NOERR)
+    printf("%s", csMsg.cStr);
+  else
+    fprintf(stderr, "%s", csMsg.cStr);
+
+  csFree(&csMsg);
+
+  exit(iErr);
+}
+
+/*******************************************************************************
+ * Name:  dispatchError
+ * Purpose: Print out specific error message, if any occurres.
+ *******************************************************************************/
+void dispatchError(int rv, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+  cstr csErr = csNew("");
+
+  if (rv == ERR_NOERR) return;
+
+  if (rv == ERR_ARGS) csSet(&csErr, sERR_ARGS);
+  if (rv == ERR_FILE) csSet(&csErr, sERR_FILE);
+  if (rv == ERR_ELSE) csSet(&csErr, sERR_ELSE);
+
+  // Set to '<err>: <message>', if a message was given.
+  if (csMsg.len != 0) csSetf(&csErr, "%s: %s", csErr.cStr, csMsg.cStr);
+
+  usage(rv, csErr.cStr);
+}
 
-// 0x6c 0x24 0x84 0x8e 0x42 0x19 0xa8 0xe1 0xc5 0xdb 0x57 0x65 0xb9 0xc6 0x14 0x88 0x8f 0x3f 0x62 0xbc 0x27 0x31 0x2d 0x88 0x67 0xc4 0xf1 0x08 0x82 0x3e 0xa4 0x2c
-//    =    =    [    .    L    a    y    e    r    .    4    /    6    :    .    ?
-// 0x6c 0x24 0x84 0x8e 0x42 0x19 0xa8 0xe1 0xc5 0xdb 0x57 0x65 0xb9 0xc6 0x14 0x9e 0xa5 0x19 0x35 0x96 0x3b 0x39 0x7f 0xa5 0x65 0xd1 0xfe 0x01 0x85 0x7d 0xcb 0x5c
-//                                                                               =    =    =    =    =    =    =    =    =    =    =    =    = 0x0a 0x0a    ?    ?
+/*******************************************************************************
+ * Name:  unescape
+ * Purpose: Converts '\n', '\t', '\\' and '\xHH' into bytes, returns count.
+ *******************************************************************************/
+size_t unescape(uchar* pucOut, const char* pcIn, size_t sLen) {
+  size_t sOut = 0;
+  char   acHex[3] = {0};
+
+  for (size_t i = 0; i < sLen; ++i) {
+    if (pcIn[i] != '\\' || i + 1 == sLen) {
+      pucOut[sOut++] = (uchar) pcIn[i];
+      continue;
+    }
+    switch (pcIn[++i]) {
+      case 'n':  pucOut[sOut++] = '\n'; break;
+      case 't':  pucOut[sOut++] = '\t'; break;
+      case '\\': pucOut[sOut++] = '\\'; break;
+      case 'x':
+        if (i + 2 >= sLen || ! isxdigit(pcIn[i + 1]) || ! isxdigit(pcIn[i + 2]))
+          dispatchError(ERR_ARGS, "Invalid '\\x' escape in crib");
+        acHex[0] = pcIn[i + 1];
+        acHex[1] = pcIn[i + 2];
+        pucOut[sOut++] = (uchar) strtol(acHex, NULL, 16);
+        i += 2;
+        break;
+      default:
+        pucOut[sOut++] = '\\';
+        pucOut[sOut++] = (uchar) pcIn[i];
+    }
+  }
+
+  return sOut;
+}
+
+/*******************************************************************************
+ * Name:  addCrib
+ * Purpose: Adds 'text[@offset]' to the cribs. An '@' without a valid number
+ *          behind it is part of the text.
+ *******************************************************************************/
+void addCrib(cstr csArg) {
+  t_crib    tCrib  = {0};
+  cstr      csOff  = csNew("");
+  long long llAt   = csInStrRev(0, csArg.cStr, "@");
+  size_t    sText  = csArg.len;
+  int       iErr   = 1;
+  ll        llOff  = 0;
+
+  if (llAt != CS_INSTR_NOT_FOUND) {
+    csMid(&csOff, csArg.cStr, llAt + 1, CS_MID_REST);
+    llOff = getHexLongParm(csOff, &iErr);
+    if (! iErr && llOff >= 0) sText = llAt;
+    else                      llOff = 0;
+  }
+
+  tCrib.pucText = (uchar*) malloc(sText + 1);
+  if (! tCrib.pucText) dispatchError(ERR_ELSE, "Out of memory");
+  tCrib.sLen = unescape(tCrib.pucText, csArg.cStr, sText);
+  tCrib.sOff = (size_t) llOff;
+  if (tCrib.sLen == 0) dispatchError(ERR_ARGS, "Crib is empty");
+
+  daAdd(t_crib, g_tOpts.tCribs, tCrib);
+
+  csFree(&csOff);
+}
+
+/*******************************************************************************
+ * Name:  addCribFile
+ * Purpose: Adds every non empty line of a file as crib.
+ *******************************************************************************/
+void addCribFile(cstr csName) {
+  FILE*   hFile   = openFile(csName.cStr, "rb");
+  cstr    csLine  = csNew("");
+  char*   pcLine  = NULL;
+  size_t  sSize   = 0;
+  ssize_t sRead   = 0;
+
+  while ((sRead = getline(&pcLine, &sSize, hFile)) != -1) {
+    if (sRead > 0 && pcLine[sRead - 1] == '\n') pcLine[--sRead] = 0;
+    if (sRead > 0 && pcLine[sRead - 1] == '\r') pcLine[--sRead] = 0;
+    if (sRead == 0) continue;
+    csSet(&csLine, pcLine);
+    addCrib(csLine);
+  }
+
+  free(pcLine);
+  csFree(&csLine);
+  fclose(hFile);
+}
+
+/*******************************************************************************
+ * Name:  setKeyHex
+ * Purpose: Sets the key from hex digits, two per byte.
+ *******************************************************************************/
+void setKeyHex(cstr csHex) {
+  char acHex[3] = {0};
+
+  if (csHex.len % 2 != 0) dispatchError(ERR_ARGS, "Key needs two hex digits per byte");
+  if (csHex.len / 2 > KEY_MAX) dispatchError(ERR_ARGS, "Key longer than 256 bytes");
+
+  for (long long i = 0; i < csHex.len; i += 2) {
+    if (! isxdigit(csHex.cStr[i]) || ! isxdigit(csHex.cStr[i + 1]))
+      dispatchError(ERR_ARGS, "Invalid hex digit in key");
+    acHex[0] = csHex.cStr[i];
+    acHex[1] = csHex.cStr[i + 1];
+    g_tOpts.aucKey[i / 2] = (uchar) strtol(acHex, NULL, 16);
+  }
+  g_tOpts.sKeyLen = csHex.len / 2;
+  ++g_tOpts.iKeySet;
+}
 
-// Possible key is:
-// 0x6c 0x24 0x84 0x8e 0x42 0x19 0xa8 0xe1 0xc5 0xdb 0x57 0x65 0xb9 0xc6 0x14 0x9e 0xa5 0x19 0x35 0x96 0x3b 0x39 0x7f 0xa5 0x65 0xd1 0xfe 0x01 0x85 0x7d 0xa4 0x2c
+/*******************************************************************************
+ * Name:  setKeyFile
+ * Purpose: Sets the key from the raw bytes of a file.
+ *******************************************************************************/
+void setKeyFile(cstr csName) {
+  FILE*  hFile = openFile(csName.cStr, "rb");
+  size_t sLen  = fread(g_tOpts.aucKey, 1, KEY_MAX, hFile);
 
-// Results of offsets 62 and 63 are wrong so 30, 31 are wrong!
-// 30, 31 are 0x5d and 0x3d "]=", but should be 0x20 and 0x5d " ]"
-// Payload at offsets 30, 31 are 0xf9 and 0x11. Xor of should been and payload
-// yields 0xd9 and 0x4c!
+  if (ferror(hFile))  dispatchError(ERR_FILE, "Error reading key file");
+  if (sLen == 0)      dispatchError(ERR_ARGS, "Key file is empty");
+  if (fgetc(hFile) != EOF) dispatchError(ERR_ARGS, "Key longer than 256 bytes");
+
+  g_tOpts.sKeyLen = sLen;
+  ++g_tOpts.iKeySet;
+
+  fclose(hFile);
+}
+
+/*******************************************************************************
+ * Name:  getOptions
+ * Purpose: Filters command line.
+ *******************************************************************************/
+void getOptions(int argc, char* argv[]) {
+  cstr csArgv = csNew("");
+  cstr csRv   = csNew("");
+  int  iArg   = 1;  // Omit program name in arg loop.
+  int  iChar  = 0;
+  char cOpt   = 0;
+
+  // Set defaults.
+  g_tOpts.iRecover   = 0;
+  g_tOpts.iGuessMax  = 0;
+  g_tOpts.iDrag      = 0;
+  g_tOpts.iKeyLen    = (int) sizeof(g_aucKey);
+  g_tOpts.iKeySet    = 0;
+  g_tOpts.sKeyLen    = sizeof(g_aucKey);
+  memcpy(g_tOpts.aucKey, g_aucKey, sizeof(g_aucKey));
+  g_tOpts.iThreads   = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  g_tOpts.iReadStdin = 0;
+
+  // Init free argument's and crib's dynamic arrays.
+  daInit(cstr, g_tArgs);
+  daInit(t_crib, g_tOpts.tCribs);
+
+  // Loop all arguments from command line POSIX style.
+  while (iArg < argc) {
+next_argument:
+    shift(&csArgv, &iArg, argc, argv);
+    if(strcmp(csArgv.cStr, "") == 0)
+      continue;
+
+    // Long options:
+    if (csArgv.cStr[0] == '-' && csArgv.cStr[1] == '-') {
+      if (!strcmp(csArgv.cStr, "--help")) {
+        usage(ERR_NOERR, "");
+      }
+      if (!strcmp(csArgv.cStr, "--version")) {
+        version();
+      }
+      if (!strcmp(csArgv.cStr, "--recover")) {
+        g_tOpts.iRecover = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--guess-keylen")) {
+        if (! getArgInt(&g_tOpts.iGuessMax, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "No valid max key length or missing");
+        if (g_tOpts.iGuessMax < 1 || g_tOpts.iGuessMax > KEY_MAX)
+          dispatchError(ERR_ARGS, "Max key length not within 1 ... 256");
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--drag")) {
+        g_tOpts.iDrag = 1;
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--cribs")) {
+        if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "Crib file is missing");
+        addCribFile(csRv);
+        continue;
+      }
+      if (!strcmp(csArgv.cStr, "--key-file")) {
+        if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+          dispatchError(ERR_ARGS, "Key file is missing");
+        setKeyFile(csRv);
+        continue;
+      }
+      dispatchError(ERR_ARGS, "Invalid long option");
+    }
+
+    // Short options:
+    if (csArgv.cStr[0] == '-') {
+      for (iChar = 1; iChar < csArgv.len; ++iChar) {
+        cOpt = csArgv.cStr[iChar];
+        if (cOpt == 'h') {
+          usage(ERR_NOERR, "");
+        }
+        if (cOpt == 'v') {
+          version();
+        }
+        if (cOpt == 'l') {
+          if (! getArgInt(&g_tOpts.iKeyLen, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid key length or missing");
+          continue;
+        }
+        if (cOpt == 'k') {
+          if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "Key is missing");
+          setKeyHex(csRv);
+          continue;
+        }
+        if (cOpt == 'c') {
+          if (! getArgStr(&csRv, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "Crib is missing");
+          addCrib(csRv);
+          continue;
+        }
+        if (cOpt == 'j') {
+          if (! getArgInt(&g_tOpts.iThreads, &iArg, argc, argv, ARG_CLI, NULL))
+            dispatchError(ERR_ARGS, "No valid thread count or missing");
+          continue;
+        }
+        dispatchError(ERR_ARGS, "Invalid short option");
+      }
+      goto next_argument;
+    }
+    // Else, it's just a filename.
+    daAdd(cstr, g_tArgs, csNew(csArgv.cStr));
+  }
+
+  // Sanity check of arguments and flags.
+  if (g_tOpts.iKeyLen < 1 || g_tOpts.iKeyLen > KEY_MAX)
+    dispatchError(ERR_ARGS, "Key length not within 1 ... 256");
+  if (g_tOpts.iThreads < 1) dispatchError(ERR_ARGS, "Thread count < 1");
+  if (g_tOpts.iRecover + (g_tOpts.iGuessMax != 0) + g_tOpts.iDrag > 1)
+    dispatchError(ERR_ARGS, "Use only one of '--recover', '--guess-keylen' or '--drag'");
+  if ((g_tOpts.iRecover || g_tOpts.iGuessMax || g_tOpts.iDrag) && g_tArgs.sCount > 1)
+    dispatchError(ERR_ARGS, "'--recover', '--guess-keylen' and '--drag' take at most one file");
+  if (g_tOpts.iDrag && g_tOpts.tCribs.sCount == 0)
+    dispatchError(ERR_ARGS, "'--drag' needs cribs");
+  if (g_tOpts.iKeySet > 1)
+    dispatchError(ERR_ARGS, "Use either '-k' or '--key-file', once");
+  if (g_tOpts.iKeySet && (g_tOpts.iRecover || g_tOpts.iGuessMax || g_tOpts.iDrag))
+    dispatchError(ERR_ARGS, "A key is only used to decrypt");
+
+  // Switch to stdin if no files were given.
+  if (g_tArgs.sCount == 0) g_tOpts.iReadStdin = 1;
+
+  // Free string memory.
+  csFree(&csArgv);
+  csFree(&csRv);
+}
 
 
 //******************************************************************************
-void theKey(int* paiKey) {
-  for (int i = 0; i < g_iKeyLen; ++i) paiKey[i] = g_aiKey[i];
+//*** kernels
+
+/*******************************************************************************
+ * Name:  initPattern
+ * Purpose: Repeats the key to a multiple of every vector width. Its period
+ *          is lcm(key length, VEC_MAX), a 32 byte key fills an AVX2 register
+ *          exactly, odd lengths need up to 64 copies.
+ *******************************************************************************/
+void initPattern(t_pattern* ptPat, const uchar* pucKey, size_t sKeyLen) {
+  size_t sGcd = sKeyLen;
+  size_t sB   = VEC_MAX;
+
+  while (sB != 0) {
+    size_t sT = sGcd % sB;
+    sGcd = sB;
+    sB   = sT;
+  }
+
+  ptPat->sKeyLen = sKeyLen;
+  ptPat->sLen    = sKeyLen / sGcd * VEC_MAX;
+  ptPat->pucPat  = (uchar*) malloc(ptPat->sLen + VEC_MAX);
+  if (! ptPat->pucPat) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (size_t i = 0; i < ptPat->sLen + VEC_MAX; ++i) ptPat->pucPat[i] = pucKey[i % sKeyLen];
 }
 
+/*******************************************************************************
+ * Name:  xorScalar
+ * Purpose: Xors 8 bytes at once, the rest byte by byte.
+ *******************************************************************************/
+void xorScalar(uchar* pucDst, const uchar* pucSrc, size_t sLen, const t_pattern* ptPat,
+               size_t sPhase) {
+  size_t i = 0;
+
+  for (i = 0; i + 8 <= sLen; i += 8) {
+    uint64_t ui64Data = 0;
+    uint64_t ui64Key  = 0;
+
+    memcpy(&ui64Data, pucSrc + i, 8);
+    memcpy(&ui64Key, ptPat->pucPat + sPhase, 8);
+    ui64Data ^= ui64Key;
+    memcpy(pucDst + i, &ui64Data, 8);
+    if ((sPhase += 8) >= ptPat->sLen) sPhase -= ptPat->sLen;
+  }
+  for (; i < sLen; ++i) {
+    pucDst[i] = pucSrc[i] ^ ptPat->pucPat[sPhase];
+    if (++sPhase == ptPat->sLen) sPhase = 0;
+  }
+}
+
+#ifdef XD_X86
+
+/*******************************************************************************
+ * Name:  xorAvx2
+ * Purpose: Xors 32 bytes per step. Keys, whose length divides 32, stay in
+ *          one register, others are loaded from the pattern.
+ *******************************************************************************/
+__attribute__((target("avx2")))
+void xorAvx2(uchar* pucDst, const uchar* pucSrc, size_t sLen, const t_pattern* ptPat,
+             size_t sPhase) {
+  size_t i = 0;
+
+  if (32 % ptPat->sKeyLen == 0) {
+    const __m256i yKey = _mm256_loadu_si256((const __m256i*) (ptPat->pucPat + sPhase));
+
+    for (i = 0; i + 32 <= sLen; i += 32) {
+      __m256i yIn = _mm256_loadu_si256((const __m256i*) (pucSrc + i));
+      _mm256_storeu_si256((__m256i*) (pucDst + i), _mm256_xor_si256(yIn, yKey));
+    }
+    sPhase = (sPhase + i) % ptPat->sLen;
+  }
+  else {
+    for (i = 0; i + 32 <= sLen; i += 32) {
+      __m256i yIn  = _mm256_loadu_si256((const __m256i*) (pucSrc + i));
+      __m256i yKey = _mm256_loadu_si256((const __m256i*) (ptPat->pucPat + sPhase));
+      _mm256_storeu_si256((__m256i*) (pucDst + i), _mm256_xor_si256(yIn, yKey));
+      if ((sPhase += 32) >= ptPat->sLen) sPhase -= ptPat->sLen;
+    }
+  }
+
+  xorScalar(pucDst + i, pucSrc + i, sLen - i, ptPat, sPhase);
+}
+
+/*******************************************************************************
+ * Name:  xorAvx512
+ * Purpose: Like xorAvx2(), but with 64 bytes per step.
+ *******************************************************************************/
+__attribute__((target("avx512f")))
+void xorAvx512(uchar* pucDst, const uchar* pucSrc, size_t sLen, const t_pattern* ptPat,
+               size_t sPhase) {
+  size_t i = 0;
+
+  if (64 % ptPat->sKeyLen == 0) {
+    const __m512i zKey = _mm512_loadu_si512((const void*) (ptPat->pucPat + sPhase));
+
+    for (i = 0; i + 64 <= sLen; i += 64) {
+      __m512i zIn = _mm512_loadu_si512((const void*) (pucSrc + i));
+      _mm512_storeu_si512((void*) (pucDst + i), _mm512_xor_si512(zIn, zKey));
+    }
+    sPhase = (sPhase + i) % ptPat->sLen;
+  }
+  else {
+    for (i = 0; i + 64 <= sLen; i += 64) {
+      __m512i zIn  = _mm512_loadu_si512((const void*) (pucSrc + i));
+      __m512i zKey = _mm512_loadu_si512((const void*) (ptPat->pucPat + sPhase));
+      _mm512_storeu_si512((void*) (pucDst + i), _mm512_xor_si512(zIn, zKey));
+      if ((sPhase += 64) >= ptPat->sLen) sPhase -= ptPat->sLen;
+    }
+  }
+
+  xorScalar(pucDst + i, pucSrc + i, sLen - i, ptPat, sPhase);
+}
+
+/*******************************************************************************
+ * Name:  hasAvx2
+ * Purpose: Checks via cpuid, if AVX2 kernel can run on this host.
+ *******************************************************************************/
+int hasAvx2(void) {
+  return __builtin_cpu_supports("avx2");
+}
+
+/*******************************************************************************
+ * Name:  hasAvx512
+ * Purpose: Checks via cpuid, if AVX-512 kernel can run on this host.
+ *******************************************************************************/
+int hasAvx512(void) {
+  return __builtin_cpu_supports("avx512f");
+}
+
+#endif // XD_X86
+
+/*******************************************************************************
+ * Name:  hasScalar
+ * Purpose: Scalar kernel runs everywhere.
+ *******************************************************************************/
+int hasScalar(void) {
+  return 1;
+}
+
+// All kernels, the last one supported by the host is used.
+t_kernel g_atKernels[] = {
+  {"scalar", hasScalar, xorScalar},
+#ifdef XD_X86
+  {"avx2",   hasAvx2,   xorAvx2},
+  {"avx512", hasAvx512, xorAvx512},
+#endif
+};
+
+// Kernel in use.
+t_kernel* g_ptKernel = &g_atKernels[0];
+
+/*******************************************************************************
+ * Name:  selectKernel
+ * Purpose: Selects the newest kernel supported by this host.
+ *******************************************************************************/
+void selectKernel(void) {
+  for (size_t i = 0; i < arraySize(g_atKernels); ++i)
+    if (g_atKernels[i].isSupported()) g_ptKernel = &g_atKernels[i];
+}
+
+//*** kernels
 //******************************************************************************
-void testText(int* paiTxt) {
-  //"==[ Layer 4/6: XOR Encryption ]=============================0x0a0x0aEx"
-  paiTxt[ 0] = 0x3d; paiTxt[ 1] = 0x3d; paiTxt[ 2] = 0x5b; paiTxt[ 3] = 0x20;
-  paiTxt[ 4] = 0x4c; paiTxt[ 5] = 0x61; paiTxt[ 6] = 0x79; paiTxt[ 7] = 0x65;
-  paiTxt[ 8] = 0x72; paiTxt[ 9] = 0x20; paiTxt[10] = 0x34; paiTxt[11] = 0x2f;
-  paiTxt[12] = 0x36; paiTxt[13] = 0x3a; paiTxt[14] = 0x20; paiTxt[15] = 0x58;
-  paiTxt[16] = 0x4f; paiTxt[17] = 0x52; paiTxt[18] = 0x20; paiTxt[19] = 0x45;
-  paiTxt[20] = 0x6e; paiTxt[21] = 0x63; paiTxt[22] = 0x72; paiTxt[23] = 0x79;
-  paiTxt[24] = 0x70; paiTxt[25] = 0x74; paiTxt[26] = 0x69; paiTxt[27] = 0x6f;
-  paiTxt[28] = 0x6e; paiTxt[29] = 0x20; paiTxt[30] = 0x5d; paiTxt[31] = 0x3d;
-  paiTxt[32] = 0x3d; paiTxt[33] = 0x3d; paiTxt[34] = 0x3d; paiTxt[35] = 0x3d;
-  paiTxt[36] = 0x3d; paiTxt[37] = 0x3d; paiTxt[38] = 0x3d; paiTxt[39] = 0x3d;
-  paiTxt[40] = 0x3d; paiTxt[41] = 0x3d; paiTxt[42] = 0x3d; paiTxt[43] = 0x3d;
-  paiTxt[44] = 0x3d; paiTxt[45] = 0x3d; paiTxt[46] = 0x3d; paiTxt[47] = 0x3d;
-  paiTxt[48] = 0x3d; paiTxt[49] = 0x3d; paiTxt[50] = 0x3d; paiTxt[51] = 0x3d;
-  paiTxt[52] = 0x3d; paiTxt[53] = 0x3d; paiTxt[54] = 0x3d; paiTxt[55] = 0x3d;
-  paiTxt[56] = 0x3d; paiTxt[57] = 0x3d; paiTxt[58] = 0x3d; paiTxt[59] = 0x3d;
-  paiTxt[60] = 0x0a; paiTxt[61] = 0x0a; paiTxt[62] = 0x45; paiTxt[63] = 0x78;
+
+
+//******************************************************************************
+//*** io
+
+/*******************************************************************************
+ * Name:  writeBlock
+ * Purpose: Writes all bytes, even if the pipe takes only a part at once.
+ *******************************************************************************/
+void writeBlock(int iFd, const uchar* pucBuf, size_t sLen) {
+  ssize_t sWritten = 0;
+
+  while (sLen > 0) {
+    if ((sWritten = write(iFd, pucBuf, sLen)) < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error writing output");
+    }
+    pucBuf += sWritten;
+    sLen   -= sWritten;
+  }
+}
+
+/*******************************************************************************
+ * Name:  readAll
+ * Purpose: Reads a whole stream into a growing buffer.
+ *******************************************************************************/
+uchar* readAll(int iFd, size_t* psLen) {
+  size_t  sSize  = BUF_SIZE;
+  size_t  sLen   = 0;
+  ssize_t sRead  = 0;
+  uchar*  pucBuf = (uchar*) malloc(sSize);
+
+  if (! pucBuf) dispatchError(ERR_ELSE, "Out of memory");
+
+  while ((sRead = read(iFd, pucBuf + sLen, sSize - sLen)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    sLen += sRead;
+    if (sLen == sSize) {
+      sSize *= 2;
+      if (! (pucBuf = (uchar*) realloc(pucBuf, sSize))) dispatchError(ERR_ELSE, "Out of memory");
+    }
+  }
+
+  *psLen = sLen;
+  return pucBuf;
 }
 
+/*******************************************************************************
+ * Name:  decryptFile
+ * Purpose: Xors a stream with the repeating key block by block. Regular files
+ *          are mapped and xored from the mapping into the output buffer.
+ *******************************************************************************/
+void decryptFile(int iFdIn, int iFdOut, const t_pattern* ptPat) {
+  uchar*      pucBuf = (uchar*) malloc(BUF_SIZE);
+  uchar*      pucMap = NULL;
+  size_t      sPhase = 0;    // Pattern position of next byte.
+  ssize_t     sRead  = 0;
+  struct stat tStat  = {0};
 
+  if (! pucBuf) dispatchError(ERR_ELSE, "Out of memory");
+
+  if (fstat(iFdIn, &tStat) == 0 && S_ISREG(tStat.st_mode) && tStat.st_size > 0 &&
+      (pucMap = (uchar*) mmap(NULL, tStat.st_size, PROT_READ, MAP_PRIVATE, iFdIn, 0)) != MAP_FAILED) {
+    madvise(pucMap, tStat.st_size, MADV_SEQUENTIAL);
+    for (size_t sOff = 0; sOff < (size_t) tStat.st_size; sOff += BUF_SIZE) {
+      size_t sLen = tStat.st_size - sOff < BUF_SIZE ? tStat.st_size - sOff : BUF_SIZE;
+
+      g_ptKernel->xorKey(pucBuf, pucMap + sOff, sLen, ptPat, sPhase);
+      sPhase = (sPhase + sLen) % ptPat->sLen;
+      writeBlock(iFdOut, pucBuf, sLen);
+    }
+    munmap(pucMap, tStat.st_size);
+  }
+  // Pipes and files, which can't be mapped.
+  else {
+    while ((sRead = read(iFdIn, pucBuf, BUF_SIZE)) != 0) {
+      if (sRead < 0) {
+        if (errno == EINTR) continue;
+        dispatchError(ERR_FILE, "Error reading file");
+      }
+      g_ptKernel->xorKey(pucBuf, pucBuf, sRead, ptPat, sPhase);
+      sPhase = (sPhase + sRead) % ptPat->sLen;
+      writeBlock(iFdOut, pucBuf, sRead);
+    }
+  }
+
+  free(pucBuf);
+}
+
+//*** io
 //******************************************************************************
-int main() {
-  int aiKey[32] = {0};
-//  int aiPay[64] = {0};
-  int c         =  0;
-  int k         =  0;
 
-//  testText(aiPay);
-  theKey(aiKey);
 
-  while ((c = getchar()) != EOF) {
-    //printf("0x%02x ", c);
-    c = aiKey[k] ^ c;
-    putchar(c);
-//    printf("0x%02x\n", aiKey[k]);
-    ++k;
-    if (k == g_iKeyLen) k = 0;
+//******************************************************************************
+//*** recover
+
+/*******************************************************************************
+ * Name:  initWeights
+ * Purpose: Letters weigh with their frequency in English text, other
+ *          printable chars a bit, everything else is a penalty.
+ *******************************************************************************/
+void initWeights(void) {
+  const double adFreq[26] = {
+    8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+    6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074
+  };
+
+  for (int b = 0; b < 256; ++b) {
+    if      (b >= 'a' && b <= 'z')                 g_adWeight[b] = adFreq[b - 'a'];
+    else if (b >= 'A' && b <= 'Z')                 g_adWeight[b] = adFreq[b - 'A'];
+    else if (b == ' ')                             g_adWeight[b] = 13.0;
+    else if (b >= 0x21 && b <= 0x7e)               g_adWeight[b] = 1.0;
+    else if (b == '\n' || b == '\r' || b == '\t') g_adWeight[b] = 1.0;
+    else                                           g_adWeight[b] = -20.0;
   }
 }
+
+/*******************************************************************************
+ * Name:  runParts
+ * Purpose: Runs a thread function for every part and waits for all.
+ *******************************************************************************/
+void runParts(void* (*fnPart)(void*), t_part* ptParts, int iParts) {
+  pthread_t* ptThread = (pthread_t*) malloc(iParts * sizeof(pthread_t));
+
+  if (! ptThread) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (int t = 0; t < iParts; ++t)
+    if (pthread_create(&ptThread[t], NULL, fnPart, &ptParts[t]))
+      dispatchError(ERR_ELSE, "Can't create thread");
+  for (int t = 0; t < iParts; ++t) pthread_join(ptThread[t], NULL);
+
+  free(ptThread);
+}
+
+/*******************************************************************************
+ * Name:  countColumns
+ * Purpose: Thread function, counts bytes of its slice of data per key
+ *          position in one pass, so the data is read only once.
+ *******************************************************************************/
+void* countColumns(void* pvPart) {
+  t_part* ptPart = (t_part*) pvPart;
+  int     iCol   = (int) (ptPart->sBeg % ptPart->iKeyLen);
+
+  for (size_t i = ptPart->sBeg; i < ptPart->sEnd; ++i) {
+    ++ptPart->pui32Hist[iCol * 256 + ptPart->pucData[i]];
+    if (++iCol == ptPart->iKeyLen) iCol = 0;
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  sumColumns
+ * Purpose: Counts bytes per key position over data slices in parallel and
+ *          returns the sum of all slices.
+ *******************************************************************************/
+uint32_t* sumColumns(const uchar* pucData, size_t sLen, int iKeyLen) {
+  int       iThreads = g_tOpts.iThreads;
+  size_t    sHist    = (size_t) iKeyLen * 256;
+  uint32_t* pui32Sum = (uint32_t*) calloc(sHist, sizeof(uint32_t));
+  uint32_t* pui32All = (uint32_t*) calloc(sHist * iThreads, sizeof(uint32_t));
+  t_part*   ptParts  = (t_part*) calloc(iThreads, sizeof(t_part));
+
+  if (! pui32Sum || ! pui32All || ! ptParts) dispatchError(ERR_ELSE, "Out of memory");
+
+  // Count per thread, then sum up.
+  for (int t = 0; t < iThreads; ++t) {
+    ptParts[t].pucData   = pucData;
+    ptParts[t].sBeg      = sLen * t / iThreads;
+    ptParts[t].sEnd      = sLen * (t + 1) / iThreads;
+    ptParts[t].iKeyLen   = iKeyLen;
+    ptParts[t].pui32Hist = pui32All + sHist * t;
+  }
+  runParts(countColumns, ptParts, iThreads);
+  for (int t = 0; t < iThreads; ++t)
+    for (size_t i = 0; i < sHist; ++i) pui32Sum[i] += ptParts[t].pui32Hist[i];
+
+  free(ptParts);
+  free(pui32All);
+
+  return pui32Sum;
+}
+
+/*******************************************************************************
+ * Name:  scoreColumns
+ * Purpose: Thread function, scores all 256 key bytes of its key positions.
+ *          Xor maps equal bytes to equal bytes, so the score is taken from
+ *          the position's histogram, not from the data itself. Confidence
+ *          is the lead of the best over the second best score.
+ *******************************************************************************/
+void* scoreColumns(void* pvPart) {
+  t_part* ptPart = (t_part*) pvPart;
+
+  for (int p = ptPart->iFirst; p < ptPart->iKeyLen; p += ptPart->iStep) {
+    const uint32_t* pui32Hist = &ptPart->pui32Hist[p * 256];
+    double          dBest     = -DBL_MAX;
+    double          dSecond   = -DBL_MAX;
+    int             iBest     = 0;
+
+    for (int k = 0; k < 256; ++k) {
+      double dScore = 0.0;
+
+      for (int c = 0; c < 256; ++c) dScore += pui32Hist[c] * g_adWeight[c ^ k];
+      if (dScore > dBest) {
+        dSecond = dBest;
+        dBest   = dScore;
+        iBest   = k;
+      }
+      else if (dScore > dSecond) {
+        dSecond = dScore;
+      }
+    }
+
+    ptPart->ptKey[p].ucKey = (uchar) iBest;
+    ptPart->ptKey[p].iFrom = FROM_FREQ;
+    ptPart->ptKey[p].dConf = dBest > 0.0 ? (dBest - dSecond) / dBest : 0.0;
+    if (ptPart->ptKey[p].dConf > 1.0) ptPart->ptKey[p].dConf = 1.0;
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  applyCribs
+ * Purpose: Known plaintext gives key bytes directly. They win over scored
+ *          ones, cribs disagreeing on a key byte are counted as conflicts.
+ *******************************************************************************/
+void applyCribs(const uchar* pucData, size_t sLen, t_keybyte* ptKey, int iKeyLen) {
+  for (size_t c = 0; c < g_tOpts.tCribs.sCount; ++c) {
+    t_crib* ptCrib = &g_tOpts.tCribs.pVal[c];
+
+    for (size_t i = 0; i < ptCrib->sLen && ptCrib->sOff + i < sLen; ++i) {
+      size_t sPos  = ptCrib->sOff + i;
+      uchar  ucKey = pucData[sPos] ^ ptCrib->pucText[i];
+      int    p     = (int) (sPos % iKeyLen);
+
+      if (ptKey[p].iFrom == FROM_CRIB) {
+        if (ptKey[p].ucKey != ucKey) ++ptKey[p].iConflicts;
+        continue;
+      }
+      ptKey[p].ucKey = ucKey;
+      ptKey[p].dConf = 1.0;
+      ptKey[p].iFrom = FROM_CRIB;
+    }
+  }
+}
+
+/*******************************************************************************
+ * Name:  recoverKey
+ * Purpose: Counts bytes per key position, scores key positions in parallel,
+ *          then applies cribs and prints the key.
+ *******************************************************************************/
+void recoverKey(int iFd) {
+  size_t     sLen     = 0;
+  uchar*     pucData  = readAll(iFd, &sLen);
+  int        iKeyLen  = g_tOpts.iKeyLen;
+  int        iThreads = g_tOpts.iThreads;
+  uint32_t*  pui32Sum = NULL;
+  t_part*    ptParts  = (t_part*) calloc(iThreads, sizeof(t_part));
+  t_keybyte  atKey[KEY_MAX];
+
+  if (! ptParts) dispatchError(ERR_ELSE, "Out of memory");
+  if (sLen == 0) dispatchError(ERR_FILE, "No data to recover the key from");
+
+  memset(atKey, 0, sizeof(atKey));
+  initWeights();
+
+  pui32Sum = sumColumns(pucData, sLen, iKeyLen);
+
+  // Score key positions.
+  for (int t = 0; t < iThreads; ++t) {
+    ptParts[t].iKeyLen   = iKeyLen;
+    ptParts[t].pui32Hist = pui32Sum;
+    ptParts[t].iFirst    = t;
+    ptParts[t].iStep     = iThreads;
+    ptParts[t].ptKey     = atKey;
+  }
+  runParts(scoreColumns, ptParts, iThreads);
+
+  applyCribs(pucData, sLen, atKey, iKeyLen);
+
+  printf("key: ");
+  for (int p = 0; p < iKeyLen; ++p) printf("%02x", atKey[p].ucKey);
+  printf("\n pos   key  conf  from\n");
+  for (int p = 0; p < iKeyLen; ++p) {
+    printf("%4d  0x%02x  %4.2f  %s", p, atKey[p].ucKey, atKey[p].dConf,
+           atKey[p].iFrom == FROM_CRIB ? "crib" : "freq");
+    if (atKey[p].iConflicts) printf(", %d conflicts", atKey[p].iConflicts);
+    printf("\n");
+  }
+
+  free(ptParts);
+  free(pui32Sum);
+  free(pucData);
+}
+
+//*** recover
+//******************************************************************************
+
+
+//******************************************************************************
+//*** guess key length
+
+/*******************************************************************************
+ * Name:  hammingScalar
+ * Purpose: Counts differing bits of data and data shifted by iLen, 8 bytes
+ *          at once.
+ *******************************************************************************/
+uint64_t hammingScalar(const uchar* pucData, size_t sLen, int iLen) {
+  uint64_t ui64Bits = 0;
+  size_t   i        = 0;
+
+  for (i = 0; i + iLen + 8 <= sLen; i += 8) {
+    uint64_t ui64A = 0;
+    uint64_t ui64B = 0;
+
+    memcpy(&ui64A, pucData + i, 8);
+    memcpy(&ui64B, pucData + i + iLen, 8);
+    ui64Bits += __builtin_popcountll(ui64A ^ ui64B);
+  }
+  for (; i + iLen < sLen; ++i) ui64Bits += __builtin_popcount(pucData[i] ^ pucData[i + iLen]);
+
+  return ui64Bits;
+}
+
+/*******************************************************************************
+ * Name:  hammingPopcnt
+ * Purpose: Like hammingScalar(), but with the popcnt instruction, 32 bytes
+ *          per step in four independent sums.
+ *******************************************************************************/
+#if defined(__x86_64__)
+__attribute__((target("popcnt")))
+uint64_t hammingPopcnt(const uchar* pucData, size_t sLen, int iLen) {
+  uint64_t aui64Bits[4] = {0};
+  size_t   i            = 0;
+
+  for (i = 0; i + iLen + 32 <= sLen; i += 32) {
+    uint64_t aui64A[4];
+    uint64_t aui64B[4];
+
+    memcpy(aui64A, pucData + i, 32);
+    memcpy(aui64B, pucData + i + iLen, 32);
+    for (int w = 0; w < 4; ++w) aui64Bits[w] += __builtin_popcountll(aui64A[w] ^ aui64B[w]);
+  }
+
+  return aui64Bits[0] + aui64Bits[1] + aui64Bits[2] + aui64Bits[3] +
+         hammingScalar(pucData + i, sLen - i, iLen);
+}
+#endif
+
+// Hamming kernel in use.
+uint64_t (*g_fnHamming)(const uchar*, size_t, int) = hammingScalar;
+
+/*******************************************************************************
+ * Name:  getIoc
+ * Purpose: Mean index of coincidence of all key positions of a sample.
+ *******************************************************************************/
+double getIoc(const uchar* pucData, size_t sLen, int iLen) {
+  uint32_t* pui32Hist = (uint32_t*) calloc((size_t) iLen * 256, sizeof(uint32_t));
+  double    dIoc      = 0.0;
+  int       iCol      = 0;
+
+  if (! pui32Hist) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (size_t i = 0; i < sLen; ++i) {
+    ++pui32Hist[iCol * 256 + pucData[i]];
+    if (++iCol == iLen) iCol = 0;
+  }
+
+  for (int p = 0; p < iLen; ++p) {
+    double dN    = (double) (sLen / iLen + (p < (int) (sLen % iLen)));
+    double dSame = 0.0;
+
+    for (int c = 0; c < 256; ++c)
+      dSame += (double) pui32Hist[p * 256 + c] * (pui32Hist[p * 256 + c] - 1);
+    if (dN > 1.0) dIoc += dSame / (dN * (dN - 1.0));
+  }
+
+  free(pui32Hist);
+  return dIoc / iLen;
+}
+
+/*******************************************************************************
+ * Name:  guessLengths
+ * Purpose: Thread function, scores its key lengths.
+ *******************************************************************************/
+void* guessLengths(void* pvGuess) {
+  t_guess* ptGuess = (t_guess*) pvGuess;
+  size_t   sIoc    = ptGuess->sLen < IOC_SAMPLE ? ptGuess->sLen : IOC_SAMPLE;
+
+  for (int l = ptGuess->iFirst; l <= ptGuess->iMax; l += ptGuess->iStep) {
+    t_keylen* ptLen  = &ptGuess->ptLens[l - 1];
+    size_t    sPairs = ptGuess->sLen > (size_t) l ? ptGuess->sLen - l : 0;
+
+    ptLen->iLen     = l;
+    ptLen->dHamming = sPairs ? (double) g_fnHamming(ptGuess->pucData, ptGuess->sLen, l) /
+                               (8.0 * sPairs) : 1.0;
+    ptLen->dIoc     = getIoc(ptGuess->pucData, sIoc, l);
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  cmpLens
+ * Purpose: Sorts key lengths by ascending hamming distance.
+ *******************************************************************************/
+int cmpLens(const void* pvA, const void* pvB) {
+  double dA = ((const t_keylen*) pvA)->dHamming;
+  double dB = ((const t_keylen*) pvB)->dHamming;
+
+  return (dA > dB) - (dA < dB);
+}
+
+/*******************************************************************************
+ * Name:  guessKeyLen
+ * Purpose: Scores key lengths in parallel and prints them ranked. Multiples
+ *          of the key length score like the key length itself, so the
+ *          shortest one close to the best hamming distance is suggested.
+ *******************************************************************************/
+void guessKeyLen(int iFd) {
+  size_t     sLen     = 0;
+  uchar*     pucData  = readAll(iFd, &sLen);
+  int        iMax     = g_tOpts.iGuessMax;
+  int        iThreads = g_tOpts.iThreads < iMax ? g_tOpts.iThreads : iMax;
+  t_keylen*  ptLens   = (t_keylen*) calloc(iMax, sizeof(t_keylen));
+  t_guess*   ptGuess  = (t_guess*)  calloc(iThreads, sizeof(t_guess));
+  pthread_t* ptThread = (pthread_t*) malloc(iThreads * sizeof(pthread_t));
+  int        iBest    = 0;
+
+  if (! ptLens || ! ptGuess || ! ptThread) dispatchError(ERR_ELSE, "Out of memory");
+  if (sLen < 2) dispatchError(ERR_FILE, "No data to guess the key length from");
+
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("popcnt")) g_fnHamming = hammingPopcnt;
+#endif
+
+  for (int t = 0; t < iThreads; ++t) {
+    ptGuess[t].pucData = pucData;
+    ptGuess[t].sLen    = sLen;
+    ptGuess[t].iFirst  = t + 1;
+    ptGuess[t].iStep   = iThreads;
+    ptGuess[t].iMax    = iMax;
+    ptGuess[t].ptLens  = ptLens;
+    if (pthread_create(&ptThread[t], NULL, guessLengths, &ptGuess[t]))
+      dispatchError(ERR_ELSE, "Can't create thread");
+  }
+  for (int t = 0; t < iThreads; ++t) pthread_join(ptThread[t], NULL);
+
+  qsort(ptLens, iMax, sizeof(t_keylen), cmpLens);
+
+  iBest = ptLens[0].iLen;
+  for (int i = 1; i < iMax; ++i)
+    if (ptLens[i].dHamming <= ptLens[0].dHamming * (1.0 + HAM_EQUAL) && ptLens[i].iLen < iBest)
+      iBest = ptLens[i].iLen;
+
+  printf("keylen: %d\n", iBest);
+  printf(" len  hamming     ioc\n");
+  for (int i = 0; i < iMax; ++i)
+    printf("%4d  %7.4f  %6.4f\n", ptLens[i].iLen, ptLens[i].dHamming, ptLens[i].dIoc);
+
+  free(ptThread);
+  free(ptGuess);
+  free(ptLens);
+  free(pucData);
+}
+
+//*** guess key length
+//******************************************************************************
+
+
+//******************************************************************************
+//*** drag
+
+/*******************************************************************************
+ * Name:  initFit
+ * Purpose: Fit of every key byte for every key position, taken from the
+ *          position's histogram like in scoreColumns(). It is the part of
+ *          the best English score, or 0.0 if less than DRAG_TEXT of the
+ *          position decrypts to text. Both are needed, small xor deltas keep
+ *          text printable, non English text scores alike for many bytes.
+ *******************************************************************************/
+float* initFit(const uint32_t* pui32Hist, int iKeyLen) {
+  float* pfFit = (float*) malloc((size_t) iKeyLen * 256 * sizeof(float));
+  int    aiText[256];
+
+  if (! pfFit) dispatchError(ERR_ELSE, "Out of memory");
+
+  for (int b = 0; b < 256; ++b)
+    aiText[b] = (b >= 0x20 && b <= 0x7e) || b == '\n' || b == '\r' || b == '\t';
+
+  for (int p = 0; p < iKeyLen; ++p) {
+    const uint32_t* pui32Col = &pui32Hist[p * 256];
+    uint64_t        ui64All  = 0;
+    double          adScore[256];
+    double          dBest    = -DBL_MAX;
+
+    for (int c = 0; c < 256; ++c) ui64All += pui32Col[c];
+
+    for (int k = 0; k < 256; ++k) {
+      adScore[k] = 0.0;
+      for (int c = 0; c < 256; ++c) adScore[k] += pui32Col[c] * g_adWeight[c ^ k];
+      if (adScore[k] > dBest) dBest = adScore[k];
+    }
+
+    for (int k = 0; k < 256; ++k) {
+      uint64_t ui64Text = 0;
+
+      for (int c = 0; c < 256; ++c) if (aiText[c ^ k]) ui64Text += pui32Col[c];
+      pfFit[p * 256 + k] = 0.0f;
+      if (ui64All && ui64Text >= DRAG_TEXT * ui64All && adScore[k] > 0.0)
+        pfFit[p * 256 + k] = (float) (adScore[k] / dBest);
+    }
+  }
+
+  return pfFit;
+}
+
+/*******************************************************************************
+ * Name:  dragCribs
+ * Purpose: Thread function, tries every crib at every offset of its slice.
+ *          A crib fits, if each key byte it gives fits its key position and,
+ *          if the crib is longer than the key, repeats with it. Most
+ *          offsets fail at the first byte, so this is a table lookup each.
+ *******************************************************************************/
+void* dragCribs(void* pvDrag) {
+  t_drag* ptDrag = (t_drag*) pvDrag;
+  int     iPos   = (int) (ptDrag->sBeg % ptDrag->iKeyLen);
+
+  for (size_t o = ptDrag->sBeg; o < ptDrag->sEnd; ++o) {
+    for (size_t c = 0; c < g_tOpts.tCribs.sCount; ++c) {
+      const t_crib* ptCrib = &g_tOpts.tCribs.pVal[c];
+      const uchar*  pucIn  = ptDrag->pucData + o;
+      int           p      = iPos;
+      size_t        i      = 0;
+      t_place       tPlace = {0};
+
+      if (ptCrib->sLen > ptDrag->sLen - o) continue;
+
+      for (i = 0; i < ptCrib->sLen; ++i) {
+        uchar ucKey = pucIn[i] ^ ptCrib->pucText[i];
+
+        if (ptDrag->pfFit[p * 256 + ucKey] < DRAG_FIT) break;
+        if (i >= (size_t) ptDrag->iKeyLen &&
+            ucKey != (pucIn[i - ptDrag->iKeyLen] ^ ptCrib->pucText[i - ptDrag->iKeyLen])) break;
+        if (++p == ptDrag->iKeyLen) p = 0;
+      }
+      if (i < ptCrib->sLen) continue;
+
+      tPlace.sOff  = o;
+      tPlace.iCrib = (int) c;
+      daAdd(t_place, ptDrag->tPlaces, tPlace);
+    }
+    if (++iPos == ptDrag->iKeyLen) iPos = 0;
+  }
+
+  return NULL;
+}
+
+/*******************************************************************************
+ * Name:  keyByte
+ * Purpose: Key byte, the i-th byte of a placement gives.
+ *******************************************************************************/
+uchar keyByte(const t_place* ptPlace, const uchar* pucData, size_t i) {
+  return pucData[ptPlace->sOff + i] ^ g_tOpts.tCribs.pVal[ptPlace->iCrib].pucText[i];
+}
+
+/*******************************************************************************
+ * Name:  coverage
+ * Purpose: Count of key positions a placement covers.
+ *******************************************************************************/
+size_t coverage(const t_place* ptPlace, int iKeyLen) {
+  size_t sLen = g_tOpts.tCribs.pVal[ptPlace->iCrib].sLen;
+
+  return sLen < (size_t) iKeyLen ? sLen : (size_t) iKeyLen;
+}
+
+/*******************************************************************************
+ * Name:  cmpPlaces
+ * Purpose: Sorts placements by crib, then by offset.
+ *******************************************************************************/
+int cmpPlaces(const void* pvA, const void* pvB) {
+  const t_place* ptA = (const t_place*) pvA;
+  const t_place* ptB = (const t_place*) pvB;
+
+  if (ptA->iCrib != ptB->iCrib) return ptA->iCrib - ptB->iCrib;
+
+  return (ptA->sOff > ptB->sOff) - (ptA->sOff < ptB->sOff);
+}
+
+/*******************************************************************************
+ * Name:  addVotes
+ * Purpose: Adds the votes of a placement to a key position x key byte table.
+ *******************************************************************************/
+void addVotes(const t_place* ptPlace, const uchar* pucData, double dWeight, double* pdVotes,
+              int iKeyLen) {
+  for (size_t i = 0; i < coverage(ptPlace, iKeyLen); ++i) {
+    int p = (int) ((ptPlace->sOff + i) % iKeyLen);
+
+    pdVotes[p * 256 + keyByte(ptPlace, pucData, i)] += dWeight;
+  }
+}
+
+/*******************************************************************************
+ * Name:  findRivals
+ * Purpose: Best and second best key byte and sum of votes per key position by
+ *          votes of other cribs, that is all votes minus the ones of the own
+ *          crib.
+ *******************************************************************************/
+void findRivals(const double* pdVotes, const double* pdOwn, int* piBest, double* pdBest,
+                double* pdNext, double* pdTotal, int iKeyLen) {
+  for (int p = 0; p < iKeyLen; ++p) {
+    piBest[p]  = 0;
+    pdBest[p]  = 0.0;
+    pdNext[p]  = 0.0;
+    pdTotal[p] = 0.0;
+    for (int k = 0; k < 256; ++k) {
+      double dVotes = pdVotes[p * 256 + k] - pdOwn[p * 256 + k];
+
+      pdTotal[p] += dVotes;
+      if (dVotes > pdBest[p]) {
+        pdNext[p] = pdBest[p];
+        pdBest[p] = dVotes;
+        piBest[p] = k;
+      }
+      else if (dVotes > pdNext[p]) pdNext[p] = dVotes;
+    }
+  }
+}
+
+/*******************************************************************************
+ * Name:  weighPlace
+ * Purpose: Weighs a placement against other cribs. Its agreement is, per key
+ *          byte, the share of their votes for it. Its balance is, per key
+ *          byte, its own vote plus their votes for it minus the votes of the
+ *          strongest other key byte, so scattered votes of false placements
+ *          don't add up against it. Votes of other placements of its own crib
+ *          don't count.
+ *******************************************************************************/
+void weighPlace(const t_place* ptPlace, const uchar* pucData, double dWeight,
+                const double* pdVotes, const double* pdOwn, const int* piBest,
+                const double* pdBest, const double* pdNext, const double* pdTotal,
+                double* pdAgree, double* pdBalance, int iKeyLen) {
+  *pdAgree   = 0.0;
+  *pdBalance = 0.0;
+
+  for (size_t i = 0; i < coverage(ptPlace, iKeyLen); ++i) {
+    int    p      = (int) ((ptPlace->sOff + i) % iKeyLen);
+    int    k      = keyByte(ptPlace, pucData, i);
+    double dFor   = pdVotes[p * 256 + k] - pdOwn[p * 256 + k];
+    double dRival = (k == piBest[p]) ? pdNext[p] : pdBest[p];
+
+    if (dFor > DRAG_EPS) *pdAgree += dFor / pdTotal[p];
+    *pdBalance += dWeight + dFor - dRival;
+  }
+}
+
+/*******************************************************************************
+ * Name:  dragKey
+ * Purpose: Drags all cribs over data slices in parallel. Every fitting
+ *          placement votes for its key bytes with 1 / placements of its crib,
+ *          so a crib fitting everywhere can't outvote one fitting once. Then
+ *          placements outweighed by other cribs are dropped, then those
+ *          agreeing too little with other cribs, until all left agree. Key
+ *          bytes leading with DRAG_LEAD times the runner-up's votes and voted
+ *          by two cribs or by a crib found about once give the partial key,
+ *          all others are printed as '??'.
+ *******************************************************************************/
+void dragKey(int iFd) {
+  size_t           sLen       = 0;
+  uchar*           pucData    = readAll(iFd, &sLen);
+  int              iKeyLen    = g_tOpts.iKeyLen;
+  int              iThreads   = g_tOpts.iThreads;
+  size_t           sCribs     = g_tOpts.tCribs.sCount;
+  size_t           sVotes     = (size_t) iKeyLen * 256;
+  uint32_t*        pui32Hist  = NULL;
+  float*           pfFit      = NULL;
+  uchar*           pucAlive   = NULL;
+  double*          pdAgree    = NULL;
+  double*          pdBalance  = NULL;
+  t_drag*          ptDrags    = (t_drag*) calloc(iThreads, sizeof(t_drag));
+  pthread_t*       ptThread   = (pthread_t*) malloc(iThreads * sizeof(pthread_t));
+  double*          pdVotes    = (double*) malloc(sVotes * sizeof(double));
+  double*          pdOwn      = (double*) calloc(sVotes, sizeof(double));
+  uint32_t*        pui32Found = (uint32_t*) calloc(sCribs, sizeof(uint32_t));
+  uint32_t*        pui32Kept  = (uint32_t*) calloc(sCribs, sizeof(uint32_t));
+  int              aiBest[KEY_MAX];     // Strongest key byte of other cribs.
+  double           adBest[KEY_MAX];
+  double           adNext[KEY_MAX];
+  double           adTotal[KEY_MAX];
+  double           adSecond[KEY_MAX];   // Votes of the runner-up.
+  int              aiWinner[KEY_MAX];
+  int              aiLead[KEY_MAX];
+  int              aiCrib[KEY_MAX];     // A crib voting for the winner.
+  int              aiCribs[KEY_MAX];    // Cribs voting for it, sorted by crib.
+  int              aiSure[KEY_MAX];     // A sure placement votes for it.
+  t_array(t_place) tPlaces;
+
+  if (! ptDrags || ! ptThread || ! pdVotes || ! pdOwn || ! pui32Found || ! pui32Kept)
+    dispatchError(ERR_ELSE, "Out of memory");
+  if (sLen == 0) dispatchError(ERR_FILE, "No data to drag cribs over");
+
+  initWeights();
+  pui32Hist = sumColumns(pucData, sLen, iKeyLen);
+  pfFit     = initFit(pui32Hist, iKeyLen);
+
+  for (int t = 0; t < iThreads; ++t) {
+    ptDrags[t].pucData = pucData;
+    ptDrags[t].sLen    = sLen;
+    ptDrags[t].sBeg    = sLen * t / iThreads;
+    ptDrags[t].sEnd    = sLen * (t + 1) / iThreads;
+    ptDrags[t].iKeyLen = iKeyLen;
+    ptDrags[t].pfFit   = pfFit;
+    daInit(t_place, ptDrags[t].tPlaces);
+    if (pthread_create(&ptThread[t], NULL, dragCribs, &ptDrags[t]))
+      dispatchError(ERR_ELSE, "Can't create thread");
+  }
+  for (int t = 0; t < iThreads; ++t) pthread_join(ptThread[t], NULL);
+
+  // Collect placements of all threads, grouped by crib.
+  daInit(t_place, tPlaces);
+  for (int t = 0; t < iThreads; ++t) {
+    for (size_t n = 0; n < ptDrags[t].tPlaces.sCount; ++n) {
+      daAdd(t_place, tPlaces, ptDrags[t].tPlaces.pVal[n]);
+      ++pui32Found[ptDrags[t].tPlaces.pVal[n].iCrib];
+    }
+    daFree(ptDrags[t].tPlaces);
+  }
+  qsort(tPlaces.pVal, tPlaces.sCount, sizeof(t_place), cmpPlaces);
+
+  pucAlive  = (uchar*)  malloc(tPlaces.sCount + 1);
+  pdAgree   = (double*) malloc((tPlaces.sCount + 1) * sizeof(double));
+  pdBalance = (double*) malloc((tPlaces.sCount + 1) * sizeof(double));
+  if (! pucAlive || ! pdAgree || ! pdBalance) dispatchError(ERR_ELSE, "Out of memory");
+  memset(pucAlive, 1, tPlaces.sCount + 1);
+
+  // Drop placements until all left are supported by other cribs.
+  while (1) {
+    int iOpposed = 0;
+    int iDrop    = 0;
+
+    memset(pdVotes, 0, sVotes * sizeof(double));
+    for (size_t n = 0; n < tPlaces.sCount; ++n)
+      if (pucAlive[n])
+        addVotes(&tPlaces.pVal[n], pucData, 1.0 / pui32Found[tPlaces.pVal[n].iCrib], pdVotes, iKeyLen);
+
+    // Crib by crib, with the votes of its own placements apart.
+    for (size_t n = 0, m = 0; n < tPlaces.sCount; n = m) {
+      double dWeight = 1.0 / pui32Found[tPlaces.pVal[n].iCrib];
+
+      for (m = n; m < tPlaces.sCount && tPlaces.pVal[m].iCrib == tPlaces.pVal[n].iCrib; ++m)
+        if (pucAlive[m]) addVotes(&tPlaces.pVal[m], pucData, dWeight, pdOwn, iKeyLen);
+      findRivals(pdVotes, pdOwn, aiBest, adBest, adNext, adTotal, iKeyLen);
+      for (size_t i = n; i < m; ++i)
+        if (pucAlive[i])
+          weighPlace(&tPlaces.pVal[i], pucData, dWeight, pdVotes, pdOwn, aiBest, adBest, adNext,
+                     adTotal, &pdAgree[i], &pdBalance[i], iKeyLen);
+      for (size_t i = n; i < m; ++i)
+        for (size_t c = 0; c < coverage(&tPlaces.pVal[i], iKeyLen); ++c) {
+          int p = (int) ((tPlaces.pVal[i].sOff + c) % iKeyLen);
+
+          pdOwn[p * 256 + keyByte(&tPlaces.pVal[i], pucData, c)] = 0.0;
+        }
+    }
+
+    // Outweighed ones go first, ones agreeing too little only, if none is.
+    for (size_t n = 0; n < tPlaces.sCount; ++n)
+      if (pucAlive[n] && pdBalance[n] < -DRAG_EPS) iOpposed = 1;
+    for (size_t n = 0; n < tPlaces.sCount; ++n)
+      if (pucAlive[n] && (iOpposed ? pdBalance[n] < -DRAG_EPS : pdAgree[n] < DRAG_AGREE)) {
+        pucAlive[n] = 0;
+        iDrop       = 1;
+      }
+    if (! iDrop) break;
+  }
+
+  for (int p = 0; p < iKeyLen; ++p) {
+    aiWinner[p] = 0;
+    adSecond[p] = 0.0;
+    for (int k = 1; k < 256; ++k)
+      if (pdVotes[p * 256 + k] > pdVotes[p * 256 + aiWinner[p]]) aiWinner[p] = k;
+    for (int k = 0; k < 256; ++k)
+      if (k != aiWinner[p] && pdVotes[p * 256 + k] > adSecond[p]) adSecond[p] = pdVotes[p * 256 + k];
+    aiLead[p]  = pdVotes[p * 256 + aiWinner[p]] > DRAG_EPS &&
+                 pdVotes[p * 256 + aiWinner[p]] >= DRAG_LEAD * adSecond[p];
+    aiCrib[p]  = -1;
+    aiCribs[p] = 0;
+    aiSure[p]  = 0;
+  }
+
+  // Winners of a single crib need a sure placement, see DRAG_ALONE.
+  for (size_t n = 0; n < tPlaces.sCount; ++n) {
+    const t_place* ptPlace = &tPlaces.pVal[n];
+    size_t         sCover  = coverage(ptPlace, iKeyLen);
+    int            iSure   = 1.0 / pui32Found[ptPlace->iCrib] >= DRAG_ALONE;
+
+    for (size_t i = 0; pucAlive[n] && i < sCover; ++i) {
+      int p = (int) ((ptPlace->sOff + i) % iKeyLen);
+
+      if (keyByte(ptPlace, pucData, i) != aiWinner[p]) continue;
+      aiSure[p] |= iSure;
+      if (aiCrib[p] == ptPlace->iCrib) continue;
+      aiCrib[p] = ptPlace->iCrib;
+      ++aiCribs[p];
+    }
+  }
+  for (int p = 0; p < iKeyLen; ++p)
+    if (aiCribs[p] < 2 && ! aiSure[p]) aiLead[p] = 0;
+
+  for (size_t n = 0; n < tPlaces.sCount; ++n)
+    if (pucAlive[n]) ++pui32Kept[tPlaces.pVal[n].iCrib];
+
+  printf("key: ");
+  for (int p = 0; p < iKeyLen; ++p)
+    if (aiLead[p]) printf("%02x", aiWinner[p]);
+    else           printf("??");
+  printf("\n pos   key   votes  runner-up\n");
+  for (int p = 0; p < iKeyLen; ++p) {
+    if (aiLead[p])
+      printf("%4d  0x%02x  %6.3f  %9.3f\n", p, aiWinner[p], pdVotes[p * 256 + aiWinner[p]],
+             adSecond[p]);
+    else
+      printf("%4d    --  %6.3f  %9.3f\n", p, pdVotes[p * 256 + aiWinner[p]], adSecond[p]);
+  }
+  printf(" crib     found      kept  text\n");
+  for (size_t c = 0; c < sCribs; ++c) {
+    const t_crib* ptCrib = &g_tOpts.tCribs.pVal[c];
+
+    printf("%5zu  %8u  %8u  ", c, pui32Found[c], pui32Kept[c]);
+    for (size_t i = 0; i < ptCrib->sLen; ++i)
+      putchar(isprint(ptCrib->pucText[i]) ? ptCrib->pucText[i] : '.');
+    printf("\n");
+  }
+
+  daFree(tPlaces);
+  free(pucAlive);
+  free(pui32Kept);
+  free(pui32Found);
+  free(pdAgree);
+  free(pdBalance);
+  free(pdOwn);
+  free(pdVotes);
+  free(ptThread);
+  free(ptDrags);
+  free(pfFit);
+  free(pui32Hist);
+  free(pucData);
+}
+
+//*** drag
+//******************************************************************************
+
+
+//******************************************************************************
+//* main
+
+int main(int argc, char *argv[]) {
+  FILE*     hFile  = NULL;
+  int       iStdin = 0;
+  t_pattern tPat   = {0};
+
+  // Save program's name.
+  g_csMename = csNew("");
+  getMename(&g_csMename, argv[0]);
+
+  // Get options and dispatch errors, if any.
+  getOptions(argc, argv);
+
+  // Recover key from first file or stdin.
+  if (g_tOpts.iRecover) {
+    hFile = g_tOpts.iReadStdin ? stdin : openFile(g_tArgs.pVal[0].cStr, "rb");
+    recoverKey(fileno(hFile));
+    fclose(hFile);
+  }
+  // Guess key length from first file or stdin.
+  else if (g_tOpts.iGuessMax) {
+    hFile = g_tOpts.iReadStdin ? stdin : openFile(g_tArgs.pVal[0].cStr, "rb");
+    guessKeyLen(fileno(hFile));
+    fclose(hFile);
+  }
+  // Drag cribs over first file or stdin.
+  else if (g_tOpts.iDrag) {
+    hFile = g_tOpts.iReadStdin ? stdin : openFile(g_tArgs.pVal[0].cStr, "rb");
+    dragKey(fileno(hFile));
+    fclose(hFile);
+  }
+  else {
+    selectKernel();
+    initPattern(&tPat, g_tOpts.aucKey, g_tOpts.sKeyLen);
+
+    // If to use stdin instead of files, say so.
+    iStdin = g_tOpts.iReadStdin;
+
+    // Get all data from all files, or stdin.
+    for (int i = 0; i < g_tArgs.sCount || iStdin; ++i) {
+      if (iStdin) {
+        hFile  = stdin;
+        iStdin = 0;
+      }
+      else {
+        hFile = openFile(g_tArgs.pVal[i].cStr, "rb");
+      }
+//-- file ----------------------------------------------------------------------
+      decryptFile(fileno(hFile), STDOUT_FILENO, &tPat);
+//-- file ----------------------------------------------------------------------
+      fclose(hFile);
+    }
+
+    free(tPat.pucPat);
+  }
+
+  // Free all used memory, prior end of program.
+  for (size_t i = 0; i < g_tOpts.tCribs.sCount; ++i) free(g_tOpts.tCribs.pVal[i].pucText);
+  daFree(g_tOpts.tCribs);
+  daFreeEx(g_tArgs, cStr);
+
+  return ERR_NOERR;
+}
@@ -0,0 +1,95 @@
+#!/bin/bash
+#*******************************************************************************
+#** Name: test.sh
+#** Purpose:  Builds xor_decrypt and checks '--drag' on the layer 4 data.
+#** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+#*******************************************************************************
+#** Date        User  Changelog
+#**-----------------------------------------------------------------------------
+#** 17.10.2026  JE    Created script, checks keys of '--drag' for some cribs.
+#*******************************************************************************
+
+
+#*******************************************************************************
+#* setup
+
+cd "$(dirname "$0")/../.." || exit 2
+
+g_tmp=$(mktemp -d)
+g_fails=0
+g_key=6c24848e4219a8e1c5db5765b9c6149ea51935963b397fa565d1fe01857dd94c
+trap 'rm -rf "$g_tmp"' EXIT
+
+for sDir in tdo00/ascii85 tdo01/xor_rbr tdo02/parityodd tdo03/xor_decrypt; do
+  gcc -Wall -Ofast -o "$g_tmp/$(basename $sDir)" $sDir/main.c -lpthread -lcrypto -lm || exit 2
+done
+
+# Peel the onion down to the layer 4 ciphertext.
+cd "$g_tmp" || exit 2
+./ascii85 "$OLDPWD/tdo00/tdo00.txt" | ./ascii85 | ./xor_rbr | ./ascii85 | ./parityodd |
+  ./ascii85 > layer4.bin || exit 2
+
+
+#*******************************************************************************
+#* functions
+
+#*******************************************************************************
+#* Name:  check
+#* Purpose: Prints result of a test and counts failed ones.
+#*******************************************************************************
+check() {
+  if [ "$2" = "$3" ]; then
+    echo "ok    $1"
+  else
+    echo "FAIL  $1: got '$2', expected '$3'"
+    g_fails=$((g_fails + 1))
+  fi
+}
+
+#*******************************************************************************
+#* Name:  dragKey
+#* Purpose: Prints the key found by '--drag' with given cribs.
+#*******************************************************************************
+dragKey() {
+  local aArgs=()
+
+  for sCrib in "$@"; do aArgs+=(-c "$sCrib"); done
+  ./xor_decrypt --drag "${aArgs[@]}" layer4.bin | sed -n 's/^key: //p'
+}
+
+#*******************************************************************************
+#* Name:  known
+#* Purpose: Prints the true key with '??' at the unknown positions of a key.
+#*******************************************************************************
+known() {
+  local sKey=""
+
+  for ((i = 0; i < ${#1}; i += 2)); do
+    if [ "${1:i:2}" = "??" ]; then sKey+="??"; else sKey+="${g_key:i:2}"; fi
+  done
+  echo "$sKey"
+}
+
+
+#*******************************************************************************
+#* tests
+
+sHeader='==[ Layer 4/6: '
+
+# Two right cribs agreeing on key bytes 4 ... 9, 'Layer ' fits 15 times.
+check "header and 'Layer ' give the header's key bytes" \
+      "$(dragKey "$sHeader" 'Layer ')" \
+      "${g_key:0:30}$(printf '??%.0s' {1..17})"
+
+# A short crib fitting everywhere must not confirm itself.
+for n in 1 2 5 10 28 47 50 60; do
+  sEq=$(printf '=%.0s' $(seq 1 $n))
+  sKey=$(dragKey "$sHeader" "$sEq" ' the ' 'Layer ')
+  check "header, '=' x $n, ' the ', 'Layer ' give no wrong key byte" \
+        "$sKey" "$(known "$sKey")"
+done
+
+check "header, '=' x 16, ' the ', 'Layer ' give the full key" \
+      "$(dragKey "$sHeader" '================' ' the ' 'Layer ')" "$g_key"
+
+exit $((g_fails > 0))
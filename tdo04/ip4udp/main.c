@@ -1,12 +1,74 @@
+/*******************************************************************************
+ ** Name: ip4udp
+ ** Purpose: Prints payloads of valid UDP packets from 10.1.1.10 to
+ **          10.1.1.200:42069 to stdout.
+ ** Author: (JE) Jens Elstner <jens.elstner@bka.bund.de>
+ *******************************************************************************
+ ** Date        User  Log
+ **-----------------------------------------------------------------------------
+ ** 17.10.2026  JE    Changed it with the standard program skeleton.
+ ** 17.10.2026  JE    Maps the capture and walks it with header pointers,
+ **                   valid payloads are written at once with writev().
+ *******************************************************************************/
+
+
+//******************************************************************************
+//* includes & namespaces
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
+#include <errno.h>
 #include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "c_string.h"
+#include "c_dynamic_arrays_macros.h"
+
+
+//******************************************************************************
+//* me and myself
+
+#define ME_VERSION "0.1.0"
+cstr g_csMename;
+
+
+//******************************************************************************
+//* defines & macros
+
+#define ERR_NOERR 0x00
+#define ERR_ARGS  0x01
+#define ERR_FILE  0x02
+#define ERR_ELSE  0xff
+
+#define sERR_ARGS  "Argument error"
+#define sERR_FILE  "File error"
+#define sERR_ELSE  "Unknown error"
+
+// Bytes read at once from pipes.
+#define BUF_SIZE (1024 * 1024)
+
+// Wanted packets.
+#define IP_SRC   "\x0a\x01\x01\x0a"   // 10.1.1.10
+#define IP_DST   "\x0a\x01\x01\xc8"   // 10.1.1.200
+#define PORT_DST 42069
+
+
+//******************************************************************************
+//* outsourced standard functions, includes and defines
 
+#include "stdfcns.c"
 
-typedef unsigned char uchar;
 
-typedef struct s_ip4head {
+//******************************************************************************
+//* typedefs
+
+// Packed, because headers are read where they are in the capture.
+typedef struct __attribute__((packed)) s_ip4head {
   uchar    ver : 4;
   uchar    ihl : 4;
   uchar    dscp : 6;
@@ -31,148 +93,411 @@ typedef struct s_ip4headUdp {
   uint16_t udpLen;
 } t_ip4headUdp;
 
-typedef struct s_udpHead {
+typedef struct __attribute__((packed)) s_udpHead {
   uint16_t portSrc;
   uint16_t portDst;
   uint16_t length;
   uint16_t checksum;
 } t_udpHead;
 
+typedef struct iovec t_iovec;
+
+s_array(cstr);
+s_array(t_iovec);
+
+// Arguments and options.
+typedef struct s_options {
+  int iReadStdin;
+} t_options;
+
 
 //******************************************************************************
-//* 1 element =  OK, 0 elements = EOF
-int readBytes(void* pvBytes, int iLength, FILE* hFile) {
-  size_t sBytesRead = 0;
+//* Global variables
 
-  sBytesRead = fread(pvBytes, iLength, 1, hFile);
+// Arguments
+t_options     g_tOpts;  // CLI options and arguments.
+t_array(cstr) g_tArgs;  // Free arguments.
 
-  return sBytesRead;
-}
 
 //******************************************************************************
-int checkIp4Integrity(t_ip4head* pIp4Head, int iSize) {
-  // IP-Adr: 10.1.1.10
-  if (pIp4Head->ipSrc[0] !=  10) return 0;
-  if (pIp4Head->ipSrc[1] !=   1) return 0;
-  if (pIp4Head->ipSrc[2] !=   1) return 0;
-  if (pIp4Head->ipSrc[3] !=  10) return 0;
-
-  // IP-Adr: 10.1.1.200
-  if (pIp4Head->ipDst[0] !=  10) return 0;
-  if (pIp4Head->ipDst[1] !=   1) return 0;
-  if (pIp4Head->ipDst[2] !=   1) return 0;
-  if (pIp4Head->ipDst[3] != 200) return 0;
+//* Functions
+
+/*******************************************************************************
+ * Name:  usage
+ * Purpose: Print help text and exit program.
+ *******************************************************************************/
+void usage(int iErr, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+
+  // Print at least one newline with message.
+  if (csMsg.len != 0)
+    csCat(&csMsg, csMsg.cStr, "\n\n");
+
+  csSetf(&csMsg, "%s"
+//|************************ 80 chars width ****************************************|
+  "usage: %s [file1 file2 ...]\n"
+  "       %s [-h|--help|-v|--version]\n"
+  " Prints the payloads of all UDP packets from 10.1.1.10 to 10.1.1.200:42069\n"
+  " with valid IPv4 and UDP checksums in file(s) to stdout. Data can also been\n"
+  " piped into the program.\n"
+  "  -h|--help:     print this help\n"
+  "  -v|--version:  print version of program\n"
+//|************************ 80 chars width ****************************************|
+         ,csMsg.cStr,
+         g_csMename.cStr, g_csMename.cStr
+        );
+
+  if (iErr == ERR_NOERR)
+    printf("%s", csMsg.cStr);
+  else
+    fprintf(stderr, "%s", csMsg.cStr);
+
+  csFree(&csMsg);
+
+  exit(iErr);
+}
 
-  return 1;
+/*******************************************************************************
+ * Name:  dispatchError
+ * Purpose: Print out specific error message, if any occurres.
+ *******************************************************************************/
+void dispatchError(int rv, const char* pcMsg) {
+  cstr csMsg = csNew(pcMsg);
+  cstr csErr = csNew("");
+
+  if (rv == ERR_NOERR) return;
+
+  if (rv == ERR_ARGS) csSet(&csErr, sERR_ARGS);
+  if (rv == ERR_FILE) csSet(&csErr, sERR_FILE);
+  if (rv == ERR_ELSE) csSet(&csErr, sERR_ELSE);
+
+  // Set to '<err>: <message>', if a message was given.
+  if (csMsg.len != 0) csSetf(&csErr, "%s: %s", csErr.cStr, csMsg.cStr);
+
+  usage(rv, csErr.cStr);
 }
 
+/*******************************************************************************
+ * Name:  getOptions
+ * Purpose: Filters command line.
+ *******************************************************************************/
+void getOptions(int argc, char* argv[]) {
+  cstr csArgv = csNew("");
+  int  iArg   = 1;  // Omit program name in arg loop.
+  int  iChar  = 0;
+  char cOpt   = 0;
+
+  // Set defaults.
+  g_tOpts.iReadStdin = 0;
+
+  // Init free argument's dynamic array.
+  daInit(cstr, g_tArgs);
+
+  // Loop all arguments from command line POSIX style.
+  while (iArg < argc) {
+next_argument:
+    shift(&csArgv, &iArg, argc, argv);
+    if(strcmp(csArgv.cStr, "") == 0)
+      continue;
+
+    // Long options:
+    if (csArgv.cStr[0] == '-' && csArgv.cStr[1] == '-') {
+      if (!strcmp(csArgv.cStr, "--help")) {
+        usage(ERR_NOERR, "");
+      }
+      if (!strcmp(csArgv.cStr, "--version")) {
+        version();
+      }
+      dispatchError(ERR_ARGS, "Invalid long option");
+    }
+
+    // Short options:
+    if (csArgv.cStr[0] == '-') {
+      for (iChar = 1; iChar < csArgv.len; ++iChar) {
+        cOpt = csArgv.cStr[iChar];
+        if (cOpt == 'h') {
+          usage(ERR_NOERR, "");
+        }
+        if (cOpt == 'v') {
+          version();
+        }
+        dispatchError(ERR_ARGS, "Invalid short option");
+      }
+      goto next_argument;
+    }
+    // Else, it's just a filename.
+    daAdd(cstr, g_tArgs, csNew(csArgv.cStr));
+  }
+
+  // Switch to stdin if no files were given.
+  if (g_tArgs.sCount == 0) g_tOpts.iReadStdin = 1;
+
+  // Free string memory.
+  csFree(&csArgv);
+}
+
+
 //******************************************************************************
-int checkUdpIntegrity(t_udpHead* pUdpHead, int iSize) {
-  uint16_t ui16HostDst = ntohs(pUdpHead->portDst);
+//*** packets
 
+/*******************************************************************************
+ * Name:  checkIp4Integrity
+ * Purpose: Packet has to be sent from IP_SRC to IP_DST.
+ *******************************************************************************/
+int checkIp4Integrity(const t_ip4head* pIp4Head) {
+  if (memcmp(pIp4Head->ipSrc, IP_SRC, 4) != 0) return 0;
+  if (memcmp(pIp4Head->ipDst, IP_DST, 4) != 0) return 0;
+
+  return 1;
+}
+
+/*******************************************************************************
+ * Name:  checkUdpIntegrity
+ * Purpose: Packet has to be sent to PORT_DST.
+ *******************************************************************************/
+int checkUdpIntegrity(const t_udpHead* pUdpHead) {
   // Watch the little endianess.
   // 0x55a4 = 21924 => 42069 = 0xa455
-  if (ui16HostDst != 42069) return 0;
+  if (ntohs(pUdpHead->portDst) != PORT_DST) return 0;
 
   return 1;
 }
 
-//******************************************************************************
-void createPseudoHeader(t_ip4headUdp* pip4u, t_ip4head* pip4, t_udpHead* pudp) {
-  for (int i = 0; i < 4; ++i) {
-    pip4u->ipSrc[i] = pip4->ipSrc[i];
-    pip4u->ipDst[i] = pip4->ipDst[i];
-  }
+/*******************************************************************************
+ * Name:  createPseudoHeader
+ * Purpose: Fills the IPv4 pseudo header, the UDP checksum is taken over.
+ *******************************************************************************/
+void createPseudoHeader(t_ip4headUdp* pip4u, const t_ip4head* pip4, const t_udpHead* pudp) {
+  memcpy(pip4u->ipSrc, pip4->ipSrc, 4);
+  memcpy(pip4u->ipDst, pip4->ipDst, 4);
   pip4u->zeros    = 0;
   pip4u->protocol = pip4->protocol;
   pip4u->udpLen   = pudp->length;
 }
 
-//******************************************************************************
-int checkSum(int iSum) {
-  int iCarry = iSum & 0x000f0000;       // Get carry nibble.
-      iSum   = iSum & 0x0000ffff;       // Delete carry from sum.
-      iSum   = iSum + (iCarry >> 16);   // Add carry.
-      iSum   = iSum ^ 0x0000ffff;       // Flip 16 bits.
-  return (iSum == 0) ? 1 : 0;
+/*******************************************************************************
+ * Name:  sumWords
+ * Purpose: Sums 16 bit words in host order byte by byte, so bytes need no
+ *          alignment. An odd last byte is padded with a trailing zero.
+ *******************************************************************************/
+uint64_t sumWords(const uchar* pucBytes, size_t sLen) {
+  uint64_t ui64Sum = 0;
+  uint16_t ui16Word = 0;
+  size_t   i        = 0;
+
+  for (i = 0; i + 2 <= sLen; i += 2) {
+    memcpy(&ui16Word, pucBytes + i, 2);
+    ui64Sum += ui16Word;
+  }
+  if (i < sLen) {
+    ui16Word = 0;
+    memcpy(&ui16Word, pucBytes + i, 1);
+    ui64Sum += ui16Word;
+  }
+
+  return ui64Sum;
 }
 
-//******************************************************************************
-int checkSumIp4(uint16_t* pui16Byte, int iSize) {
-  int iSum   = 0;
-  int iCount = iSize / 2;
+/*******************************************************************************
+ * Name:  checkSum
+ * Purpose: Folds all carries into 16 bits, a valid sum is 0xffff then.
+ *******************************************************************************/
+int checkSum(uint64_t ui64Sum) {
+  while (ui64Sum >> 16) ui64Sum = (ui64Sum & 0xffff) + (ui64Sum >> 16);
 
-  for (int i = 0; i < iCount; ++i) iSum += pui16Byte[i];
+  return ui64Sum == 0xffff;
+}
 
-  return checkSum(iSum);
+/*******************************************************************************
+ * Name:  checkSumIp4
+ * Purpose: Checks the IPv4 header checksum.
+ *******************************************************************************/
+int checkSumIp4(const t_ip4head* pIp4Head) {
+  return checkSum(sumWords((const uchar*) pIp4Head, sizeof(t_ip4head)));
 }
 
-//******************************************************************************
-int checkSumUdp(uint16_t* pui16ip4, int iSIp4,
-                uint16_t* pui16udp, int iSUdp,
-                uint16_t* pui16pld, int iSPld) {
-  int iSum   = 0;
-  int iCIp4  = iSIp4 / 2;
-  int iCUdp  = iSUdp / 2;
-  int isOdd  = iSPld % 2;
-  int iCPld  = iSPld / 2;   // Integer division get rid of not needed 0.5.
-
-  // Pad last byte into an 16 bit integer with trailing zero.
-  uint16_t iLastPl = 0;
-  if (isOdd) iLastPl = ((uchar*) pui16pld)[iSPld - 1];
-
-  for (int i = 0; i < iCIp4; ++i) iSum += pui16ip4[i];
-  for (int i = 0; i < iCUdp; ++i) iSum += pui16udp[i];
-  for (int i = 0; i < iCPld; ++i) iSum += pui16pld[i];
-  if (isOdd)                      iSum += iLastPl;
-
-  return checkSum(iSum);
+/*******************************************************************************
+ * Name:  checkSumUdp
+ * Purpose: Checks the UDP checksum over pseudo header, header and payload.
+ *******************************************************************************/
+int checkSumUdp(const t_ip4headUdp* pIp4HeadU, const t_udpHead* pUdpHead,
+                const uchar* pucPayload, size_t sLen) {
+  return checkSum(sumWords((const uchar*) pIp4HeadU, sizeof(t_ip4headUdp)) +
+                  sumWords((const uchar*) pUdpHead,  sizeof(t_udpHead)) +
+                  sumWords(pucPayload, sLen));
 }
 
-//******************************************************************************
-void printPayload(uchar* pucBytes, int iLength) {
-  for (int i = 0; i < iLength; ++i)
-    printf("%c", pucBytes[i]);
+/*******************************************************************************
+ * Name:  collectPayloads
+ * Purpose: Walks all packets with header pointers into the capture and
+ *          adds the payload of every valid one as an iovec. A truncated
+ *          packet ends the capture.
+ *******************************************************************************/
+void collectPayloads(const uchar* pucCap, size_t sLen, t_array(t_iovec)* ptIov) {
+  size_t       sOff     = 0;
+  t_ip4headUdp ip4HeadU = {0};
+
+  while (sOff + sizeof(t_ip4head) + sizeof(t_udpHead) <= sLen) {
+    const t_ip4head* pIp4Head   = (const t_ip4head*) (pucCap + sOff);
+    const t_udpHead* pUdpHead   = (const t_udpHead*) (pucCap + sOff + sizeof(t_ip4head));
+    const uchar*     pucPayload = pucCap + sOff + sizeof(t_ip4head) + sizeof(t_udpHead);
+    size_t           sUdpLen    = ntohs(pUdpHead->length);
+    size_t           sPayload   = sUdpLen - sizeof(t_udpHead);
+    t_iovec          tIov       = {0};
+
+    if (sUdpLen < sizeof(t_udpHead) || sOff + sizeof(t_ip4head) + sUdpLen > sLen) break;
+    sOff += sizeof(t_ip4head) + sUdpLen;
+
+    // Check integrity of headers.
+    if (! checkIp4Integrity(pIp4Head)) continue;
+    if (! checkUdpIntegrity(pUdpHead)) continue;
+
+    // Check checksums.
+    createPseudoHeader(&ip4HeadU, pIp4Head, pUdpHead);
+    if (! checkSumIp4(pIp4Head))                                  continue;
+    if (! checkSumUdp(&ip4HeadU, pUdpHead, pucPayload, sPayload)) continue;
+
+    tIov.iov_base = (void*) pucPayload;
+    tIov.iov_len  = sPayload;
+    daAdd(t_iovec, (*ptIov), tIov);
+  }
 }
 
+//*** packets
+//******************************************************************************
+
 
 //******************************************************************************
-int main(int argc, char* argv[]) {
-  FILE*        hFile    = NULL;
-  t_ip4head    ip4Head  = {0};
-  t_ip4headUdp ip4HeadU = {0};
-  t_udpHead    udpHead  = {0};
-  uchar*       pucData  = NULL;
-  uint16_t     ui16Len  = 0;
+//*** io
+
+/*******************************************************************************
+ * Name:  writeVectors
+ * Purpose: Writes all iovecs, at most IOV_MAX per call, and continues after
+ *          short writes.
+ *******************************************************************************/
+void writeVectors(int iFd, t_iovec* ptIov, size_t sCount) {
+  long    lMax     = sysconf(_SC_IOV_MAX);
+  ssize_t sWritten = 0;
+
+  if (lMax < 1) lMax = 16;   // _XOPEN_IOV_MAX, the least POSIX allows.
+
+  while (sCount > 0) {
+    if ((sWritten = writev(iFd, ptIov, sCount < (size_t) lMax ? (int) sCount : (int) lMax)) < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error writing output");
+    }
+    // Skip what was written, the last one may be partly written.
+    while (sCount > 0 && (size_t) sWritten >= ptIov->iov_len) {
+      sWritten -= ptIov->iov_len;
+      ++ptIov;
+      --sCount;
+    }
+    if (sCount > 0) {
+      ptIov->iov_base  = (uchar*) ptIov->iov_base + sWritten;
+      ptIov->iov_len  -= sWritten;
+    }
+  }
+}
 
-  if (! (hFile = fopen(argv[1], "rb"))) {
-    perror("couldn't open file");
-    return 1;
+/*******************************************************************************
+ * Name:  readAll
+ * Purpose: Reads a whole stream into a growing buffer.
+ *******************************************************************************/
+uchar* readAll(int iFd, size_t* psLen) {
+  size_t  sSize  = BUF_SIZE;
+  size_t  sLen   = 0;
+  ssize_t sRead  = 0;
+  uchar*  pucBuf = (uchar*) malloc(sSize);
+
+  if (! pucBuf) dispatchError(ERR_ELSE, "Out of memory");
+
+  while ((sRead = read(iFd, pucBuf + sLen, sSize - sLen)) != 0) {
+    if (sRead < 0) {
+      if (errno == EINTR) continue;
+      dispatchError(ERR_FILE, "Error reading file");
+    }
+    sLen += sRead;
+    if (sLen == sSize) {
+      sSize *= 2;
+      if (! (pucBuf = (uchar*) realloc(pucBuf, sSize))) dispatchError(ERR_ELSE, "Out of memory");
+    }
   }
 
-  while (1) {
-    // Get the headers and check if the file is eof.
-    if (! readBytes(&ip4Head, sizeof(ip4Head), hFile)) break;
-    if (! readBytes(&udpHead, sizeof(udpHead), hFile)) break;
+  *psLen = sLen;
+  return pucBuf;
+}
 
-    // Get the payload.
-    ui16Len = ntohs(udpHead.length) - sizeof(udpHead);
-    pucData = (uchar*) realloc(pucData, ui16Len);
-    readBytes(pucData, ui16Len, hFile);
+/*******************************************************************************
+ * Name:  printPayloads
+ * Purpose: Maps a regular file, reads anything else whole, and writes the
+ *          payloads of its valid packets straight from there.
+ *******************************************************************************/
+void printPayloads(int iFd) {
+  struct stat      tStat  = {0};
+  uchar*           pucMap = NULL;
+  uchar*           pucBuf = NULL;
+  size_t           sLen   = 0;
+  t_array(t_iovec) tIov;
+
+  daInit(t_iovec, tIov);
+
+  if (fstat(iFd, &tStat) == 0 && S_ISREG(tStat.st_mode) && tStat.st_size > 0 &&
+      (pucMap = (uchar*) mmap(NULL, tStat.st_size, PROT_READ, MAP_PRIVATE, iFd, 0)) != MAP_FAILED) {
+    sLen = tStat.st_size;
+    madvise(pucMap, sLen, MADV_SEQUENTIAL);
+    collectPayloads(pucMap, sLen, &tIov);
+    writeVectors(STDOUT_FILENO, tIov.pVal, tIov.sCount);
+    munmap(pucMap, sLen);
+  }
+  // Pipes and files, which can't be mapped.
+  else {
+    pucBuf = readAll(iFd, &sLen);
+    collectPayloads(pucBuf, sLen, &tIov);
+    writeVectors(STDOUT_FILENO, tIov.pVal, tIov.sCount);
+    free(pucBuf);
+  }
 
-    // Check inegrity of headers.
-    createPseudoHeader(&ip4HeadU, &ip4Head, &udpHead);
-    if (! checkIp4Integrity(&ip4Head, sizeof(ip4Head))) continue;
-    if (! checkUdpIntegrity(&udpHead, sizeof(udpHead))) continue;
+  daFree(tIov);
+}
+
+//*** io
+//******************************************************************************
 
-    // Check checksums.
-    if (! checkSumIp4((uint16_t*) &ip4Head,  sizeof(ip4Head))) continue;
-    if (! checkSumUdp((uint16_t*) &ip4HeadU, sizeof(ip4HeadU),
-                      (uint16_t*) &udpHead,  sizeof(udpHead),
-                      (uint16_t*) pucData,   ui16Len))         continue;
 
-    printPayload(pucData, ui16Len);
+//******************************************************************************
+//* main
+
+int main(int argc, char *argv[]) {
+  FILE* hFile  = NULL;
+  int   iStdin = 0;
+
+  // Save program's name.
+  g_csMename = csNew("");
+  getMename(&g_csMename, argv[0]);
+
+  // Get options and dispatch errors, if any.
+  getOptions(argc, argv);
+
+  // If to use stdin instead of files, say so.
+  iStdin = g_tOpts.iReadStdin;
+
+  // Get all data from all files, or stdin.
+  for (int i = 0; i < g_tArgs.sCount || iStdin; ++i) {
+    if (iStdin) {
+      hFile  = stdin;
+      iStdin = 0;
+    }
+    else {
+      hFile = openFile(g_tArgs.pVal[i].cStr, "rb");
+    }
+//-- file ----------------------------------------------------------------------
+    printPayloads(fileno(hFile));
+//-- file ----------------------------------------------------------------------
+    fclose(hFile);
   }
 
-  fclose(hFile);
+  // Free all used memory, prior end of program.
+  daFreeEx(g_tArgs, cStr);
+
+  return ERR_NOERR;
 }